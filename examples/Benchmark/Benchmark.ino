@@ -0,0 +1,184 @@
+/*
+  Benchmark.ino - Cycle counts for the poll -> response path
+
+  Times each stage of the protocol with TCB2 running at CLK_PER (one
+  count per CPU cycle) and prints a CSV table over Serial, so results
+  from different library versions can be compared with a diff or a
+  spreadsheet.
+
+  Stages:
+  - checksum       calculateChecksum() over a poll header
+  - validate       validatePacket() on a MEASUREMENT poll
+  - set_value      setSensorValue(): slot lookup, filters, frame build
+  - handle_set     EveryIBusSensor::set(): the same without the lookup
+  - update_idle    update() with nothing received, including the two
+                   micros() reads behind getMaxUpdateMicros()
+  - poll_response  update() for a waiting MEASUREMENT poll: parse, slot
+                   lookup and queueing the reply in sendPacket()
+
+  Hardware Setup:
+  - Same as normal: D0→SENS, D1→1kΩ→SENS, but with the receiver
+    unplugged. The resistor loops TX back to RX, so polls written by the
+    sketch arrive on Serial1 like polls from a receiver.
+  - Without the loopback poll_response is reported as skipped.
+
+  Every stage has a fixed cycle budget for its worst case. The last line
+  reads "result,pass" or "result,fail". The budgets are estimates, not
+  yet checked against a measured run; tighten them from a board's output.
+  Nothing runs this sketch automatically: simavr doesn't model the
+  ATmega4809, so there is no simulator gate yet.
+
+  The reply is shifted out by the TX interrupt after update() returns, so
+  it isn't part of the poll_response figure. The longest update() seen by
+  the library itself (getMaxUpdateMicros()) is printed at the end.
+
+  Don't use EveryIBusRPM with TCB2 in the same sketch.
+*/
+
+#include <EveryIBus.h>
+
+#define ITERATIONS 200
+
+EveryIBus ibus;
+EveryIBusSensor temperature;
+
+struct Stage {
+  const char* name;
+  uint16_t budget;       // Worst case allowed, in cycles
+  uint16_t minCycles;
+  uint16_t maxCycles;
+  uint32_t totalCycles;
+  uint16_t count;
+};
+
+Stage stages[] = {
+  { "checksum",        100, 0xFFFF, 0, 0, 0 },
+  { "validate",        150, 0xFFFF, 0, 0, 0 },
+  { "set_value",      1500, 0xFFFF, 0, 0, 0 },
+  { "handle_set",     1200, 0xFFFF, 0, 0, 0 },
+  { "update_idle",     400, 0xFFFF, 0, 0, 0 },
+  { "poll_response",  3000, 0xFFFF, 0, 0, 0 },
+};
+
+enum { CHECKSUM, VALIDATE, SET_VALUE, HANDLE_SET, UPDATE_IDLE, POLL_RESPONSE };
+
+uint16_t overhead = 0;
+uint8_t poll[4];
+
+void startCycleCounter() {
+  TCB2.CTRLA = 0;
+  TCB2.CTRLB = TCB_CNTMODE_INT_gc;   // Free count up to CCMP
+  TCB2.CCMP = 0xFFFF;
+  TCB2.CNT = 0;
+  TCB2.CTRLA = TCB_CLKSEL_CLKDIV1_gc | TCB_ENABLE_bm;
+}
+
+void record(uint8_t stage, uint16_t start, uint16_t end) {
+  uint16_t cycles = (uint16_t)(end - start) - overhead;
+  Stage& s = stages[stage];
+  if (cycles < s.minCycles) s.minCycles = cycles;
+  if (cycles > s.maxCycles) s.maxCycles = cycles;
+  s.totalCycles += cycles;
+  s.count++;
+}
+
+// Time a statement with interrupts off so millis() doesn't add noise
+#define MEASURE(stage, code) do {          \
+    noInterrupts();                         \
+    uint16_t t0 = TCB2.CNT;                 \
+    code;                                   \
+    uint16_t t1 = TCB2.CNT;                 \
+    interrupts();                           \
+    record(stage, t0, t1);                  \
+  } while (0)
+
+volatile uint16_t sink;
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {}
+
+  ibus.begin();
+  ibus.setExternalVoltage(12.41);
+  temperature = ibus.addSensor(IBUS_SENSOR_TEMPERATURE);
+  temperature.setTemperature(21.0);
+  startCycleCounter();
+
+  // MEASUREMENT poll for address 1
+  poll[0] = 0x04;
+  poll[1] = IBUS_CMD_MEASUREMENT | 1;
+  uint16_t checksum = EveryIBus::calculateChecksum(poll, 2);
+  poll[2] = checksum & 0xFF;
+  poll[3] = checksum >> 8;
+
+  // Cost of reading the counter itself
+  noInterrupts();
+  uint16_t t0 = TCB2.CNT;
+  uint16_t t1 = TCB2.CNT;
+  interrupts();
+  overhead = t1 - t0;
+
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    MEASURE(CHECKSUM, sink = EveryIBus::calculateChecksum(poll, 2));
+    MEASURE(VALIDATE, sink = EveryIBus::validatePacket(poll));
+    MEASURE(SET_VALUE, ibus.setSensorValue(IBUS_SENSOR_EXTERNAL_VOLTAGE, 1200 + (i & 0x3F)));
+    MEASURE(HANDLE_SET, temperature.set(600 + (i & 0x3F)));
+    MEASURE(UPDATE_IDLE, ibus.update());
+
+    // Loop a poll back through the resistor and time its handling.
+    // Interrupts stay on: the USART needs them to transmit.
+    Serial1.write(poll, sizeof(poll));
+    Serial1.flush();
+    uint32_t waitStart = micros();
+    while (Serial1.available() < 4 && micros() - waitStart < 2000) {}
+    if (Serial1.available() >= 4) {
+      uint16_t s0 = TCB2.CNT;
+      ibus.update();
+      uint16_t s1 = TCB2.CNT;
+      record(POLL_RESPONSE, s0, s1);
+    }
+
+    // Let the library skip its looped-back response before the next round
+    delay(2);
+    ibus.update();
+  }
+
+  // Machine-readable results
+  Serial.print(F("# EveryIBus "));
+  Serial.print(F(EVERYIBUS_VERSION));
+  Serial.print(F(", F_CPU "));
+  Serial.println(F_CPU);
+  Serial.println(F("stage,min_cycles,avg_cycles,max_cycles,samples,budget_cycles,status"));
+
+  bool pass = true;
+  for (uint8_t i = 0; i < sizeof(stages) / sizeof(stages[0]); i++) {
+    Stage& s = stages[i];
+    Serial.print(s.name);
+    if (s.count == 0) {
+      Serial.print(F(",,,,0,"));
+      Serial.print(s.budget);
+      Serial.println(F(",skipped"));
+      continue;
+    }
+    bool ok = s.maxCycles <= s.budget;
+    pass = pass && ok;
+    Serial.print(',');
+    Serial.print(s.minCycles);
+    Serial.print(',');
+    Serial.print(s.totalCycles / s.count);
+    Serial.print(',');
+    Serial.print(s.maxCycles);
+    Serial.print(',');
+    Serial.print(s.count);
+    Serial.print(',');
+    Serial.print(s.budget);
+    Serial.println(ok ? F(",ok") : F(",over"));
+  }
+  Serial.print(F("# max update() "));
+  Serial.print(ibus.getMaxUpdateMicros());
+  Serial.println(F(" us"));
+  Serial.println(pass ? F("result,pass") : F("result,fail"));
+}
+
+void loop() {
+}
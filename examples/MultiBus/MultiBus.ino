@@ -0,0 +1,69 @@
+/*
+  MultiBus.ino - Several independent iBUS sensor buses on one board
+  
+  Each receiver gets its own USART and its own EveryIBus instance.
+  An EveryIBusGroup services all buses from one update() call and
+  publishes shared sensor values to every bus at once.
+  
+  Hardware Setup (per bus):
+  - USART RX → direct connection to receiver SENS pin
+  - USART TX → 1kΩ resistor → receiver SENS pin
+  - GND → receiver GND
+  
+  Note: The standard Nano Every core only provides Serial1 on D0/D1,
+  so there the example runs a single bus. Additional USARTs (Serial2,
+  Serial3) are available with cores such as MegaCoreX.
+*/
+
+#include <EveryIBus.h>
+
+EveryIBus primaryBus;
+#if defined(HAVE_HWSERIAL2)
+EveryIBus backupBus;
+#endif
+EveryIBusGroup buses;
+
+void setup() {
+  Serial.begin(115200);
+  
+  primaryBus.begin(Serial1);
+  buses.addBus(primaryBus);
+  
+#if defined(HAVE_HWSERIAL2)
+  backupBus.begin(Serial2);
+  buses.addBus(backupBus);
+#endif
+  
+  Serial.println("EveryIBus Multi-Bus Example");
+}
+
+void loop() {
+  // Services every bus once - bounded time per call
+  buses.update();
+  
+  // Shared values are converted once and reported on both links
+  static uint32_t lastUpdate = 0;
+  if (millis() - lastUpdate > 100) {
+    lastUpdate = millis();
+    
+    buses.setExternalVoltage(analogRead(A0) * (15.0 / 1023.0));
+    buses.setTemperature(21.12);
+  }
+  
+  // Per-bus statistics
+  static uint32_t lastStats = 0;
+  if (millis() - lastStats > 5000) {
+    lastStats = millis();
+    
+    for (uint8_t i = 0; i < buses.getBusCount(); i++) {
+      Serial.print("Bus ");
+      Serial.print(i);
+      Serial.print(" - Packets: ");
+      Serial.print(buses.getBus(i).getPacketCount());
+      Serial.print(", Responses: ");
+      Serial.print(buses.getBus(i).getResponseCount());
+      Serial.print(", Discovered: ");
+      Serial.println(buses.getBus(i).isDiscovered() ? "Yes" : "No");
+    }
+  }
+}
@@ -27,8 +27,10 @@ void setup() {
   // Super simple initialization!
   ibus.begin();  // Uses Serial1 by default
   
-  // Optional: Enable debug output
+  // Optional: Enable debug output (set EVERYIBUS_DEBUG to 1 or 2 in EveryIBusConfig.h)
+#if EVERYIBUS_DEBUG
   ibus.setDebug(true);
+#endif
   
   Serial.println("EveryIBus Multi-Sensor Example");
   Serial.println("Check your FS-i6 for: IntV, ExtV, Temp, RPM");
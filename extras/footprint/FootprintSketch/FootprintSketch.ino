@@ -0,0 +1,110 @@
+/*
+  FootprintSketch.ino - Build target for extras/footprint/footprint.sh
+  
+  Not an example: the script compiles this sketch once per configuration
+  with different -D flags and records the resulting .text/.data/.bss.
+  
+  FP_FLOAT   use the float setters instead of raw setSensorValue()
+  FP_DEBUG   enable runtime debug output (with EVERYIBUS_DEBUG 1 or 2)
+  FP_GROUP   service the bus through an EveryIBusGroup
+  FP_ADC     sample voltages with EveryIBusADC
+  FP_RPM     measure RPM with EveryIBusRPM
+  FP_SPORT   answer FrSky S.Port polls with EveryIBusSPort instead
+  FP_CRSF    send CRSF telemetry with EveryIBusCRSF instead
+  FP_MASTER  poll other sensors with EveryIBusMaster and forward them
+*/
+
+#include <EveryIBus.h>
+#if FP_ADC
+#include <EveryIBusADC.h>
+#endif
+#if FP_RPM
+#include <EveryIBusRPM.h>
+#endif
+#if FP_SPORT
+#include <EveryIBusSPort.h>
+#endif
+#if FP_CRSF
+#include <EveryIBusCRSF.h>
+#endif
+#if FP_MASTER
+#include <EveryIBusMaster.h>
+#endif
+
+EveryIBus ibus;
+#if FP_GROUP
+EveryIBusGroup group;
+#endif
+#if FP_ADC
+EveryIBusADC adc;
+#endif
+#if FP_RPM
+EveryIBusRPM rpm;
+#endif
+#if FP_SPORT
+EveryIBusSPort sport;
+#endif
+#if FP_CRSF
+EveryIBusCRSF crsf;
+#endif
+#if FP_MASTER
+EveryIBusMaster master;
+#endif
+
+void setup() {
+#if FP_SPORT
+  sport.begin(ibus, 0x0D);
+#elif FP_CRSF
+  crsf.begin(ibus);
+#elif FP_MASTER
+  master.begin(Serial1);
+#else
+  ibus.begin();
+#endif
+#if FP_DEBUG && EVERYIBUS_DEBUG
+  Serial.begin(115200);
+  ibus.setDebug(true);
+#endif
+#if FP_GROUP
+  group.addBus(ibus);
+#endif
+#if FP_ADC
+  adc.addChannel(A0, IBUS_SENSOR_EXTERNAL_VOLTAGE, 1500);
+  adc.addTemperature();
+  adc.begin();
+#endif
+#if FP_RPM
+  rpm.begin(2);
+#endif
+}
+
+void loop() {
+#if FP_GROUP
+  group.update();
+#elif FP_SPORT
+  sport.update();
+#elif FP_CRSF
+  crsf.update();
+#elif FP_MASTER
+  master.update();
+  master.publishTo(ibus);
+#else
+  ibus.update();
+#endif
+#if FP_ADC
+  adc.update(ibus);
+#endif
+#if FP_RPM
+  rpm.update(ibus);
+#endif
+
+  // Values the optimizer can't fold away
+  uint16_t sample = analogRead(A1);
+#if FP_FLOAT
+  ibus.setInternalVoltage(sample * (5.0f / 1023.0f));
+  ibus.setTemperature(sample * 0.1f - 20.0f);
+#else
+  ibus.setSensorValue(IBUS_SENSOR_INTERNAL_VOLTAGE, sample / 2);
+  ibus.setSensorValue(IBUS_SENSOR_TEMPERATURE, sample);
+#endif
+}
@@ -0,0 +1,93 @@
+#!/usr/bin/env bash
+#
+# footprint.sh - Flash and RAM footprint of EveryIBus per configuration
+#
+# Compiles FootprintSketch for the Nano Every once per line of
+# configs.txt, reads .text/.data/.bss with avr-size and prints a CSV
+# table. Exits non-zero if any configuration exceeds its limits.
+#
+# With --baseline PERCENT it prints configs.txt instead, each limit set
+# to the measured size plus PERCENT (rounded up to 50 bytes), to record
+# a new baseline after an intended size change.
+#
+# Requirements: arduino-cli with the arduino:megaavr core installed.
+#
+# Usage: extras/footprint/footprint.sh [fqbn] > footprint.csv
+#        extras/footprint/footprint.sh --baseline 10 [fqbn] > configs.txt.new
+#
+
+set -euo pipefail
+
+MARGIN=""
+if [ "${1:-}" = "--baseline" ]; then
+    MARGIN="${2:?--baseline needs a margin in percent}"
+    shift 2
+fi
+FQBN="${1:-arduino:megaavr:nona4809}"
+HERE="$(cd "$(dirname "$0")" && pwd)"
+LIBRARY="$(cd "$HERE/../.." && pwd)"
+SKETCH="$HERE/FootprintSketch"
+BUILD_ROOT="$(mktemp -d)"
+trap 'rm -rf "$BUILD_ROOT"' EXIT
+
+# avr-size ships with the core's toolchain if it isn't on PATH
+AVR_SIZE="$(command -v avr-size || true)"
+if [ -z "$AVR_SIZE" ]; then
+    AVR_SIZE="$(ls -1 "$HOME"/.arduino15/packages/arduino/tools/avr-gcc/*/bin/avr-size 2>/dev/null | tail -n 1 || true)"
+fi
+if [ -z "$AVR_SIZE" ]; then
+    echo "footprint.sh: avr-size not found" >&2
+    exit 2
+fi
+
+# Measured size plus the margin, rounded up to 50 bytes
+with_margin() {
+    local size=$(( ($1 * (100 + MARGIN) + 99) / 100 ))
+    echo $(( (size + 49) / 50 * 50 ))
+}
+
+if [ -z "$MARGIN" ]; then
+    echo "config,text,data,bss,flash,ram,max_flash,max_ram,status"
+fi
+
+failed=0
+while IFS= read -r line; do
+    read -r name max_flash max_ram flags <<< "$line" || true
+    case "$name" in
+        ''|'#'*)
+            # Comments carry over into a new baseline
+            [ -n "$MARGIN" ] && echo "$line"
+            continue
+            ;;
+    esac
+
+    build="$BUILD_ROOT/$name"
+    if ! arduino-cli compile --fqbn "$FQBN" --library "$LIBRARY" \
+            --build-path "$build" \
+            --build-property "compiler.cpp.extra_flags=${flags:-}" \
+            "$SKETCH" > "$build.log" 2>&1; then
+        [ -z "$MARGIN" ] && echo "$name,,,,,,$max_flash,$max_ram,build-error"
+        cat "$build.log" >&2
+        failed=1
+        continue
+    fi
+
+    # Berkeley format: text data bss dec hex filename
+    read -r text data bss _ < <("$AVR_SIZE" "$build/FootprintSketch.ino.elf" | tail -n 1)
+    flash=$((text + data))
+    ram=$((data + bss))
+
+    if [ -n "$MARGIN" ]; then
+        printf '%-17s %-10s %-8s %s\n' "$name" "$(with_margin "$flash")" "$(with_margin "$ram")" "${flags:-}"
+        continue
+    fi
+
+    status=ok
+    if [ "$flash" -gt "$max_flash" ] || [ "$ram" -gt "$max_ram" ]; then
+        status=over
+        failed=1
+    fi
+    echo "$name,$text,$data,$bss,$flash,$ram,$max_flash,$max_ram,$status"
+done < "$HERE/configs.txt"
+
+exit $failed
@@ -0,0 +1,246 @@
+/*
+  Arduino.cpp - Minimal Arduino API for running EveryIBus on Linux
+*/
+
+#include "Arduino.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+
+HardwareSerial Serial(STDOUT_FILENO);
+HardwareSerial Serial1;
+
+// ---------------------------------------------------------------------------
+// Time - wraps like the AVR counters do
+// ---------------------------------------------------------------------------
+
+static uint64_t monotonicMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static const uint64_t startMicros = monotonicMicros();
+
+uint32_t millis() {
+    return (uint32_t)((monotonicMicros() - startMicros) / 1000);
+}
+
+uint32_t micros() {
+    return (uint32_t)(monotonicMicros() - startMicros);
+}
+
+void delay(uint32_t ms) {
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR) {}
+}
+
+// ---------------------------------------------------------------------------
+// Pins
+// ---------------------------------------------------------------------------
+
+static uint8_t pinLevels[256];
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    pinLevels[pin] = level ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    return pinLevels[pin];
+}
+
+// ---------------------------------------------------------------------------
+// Print
+// ---------------------------------------------------------------------------
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        n += write(*buffer++);
+    }
+    return n;
+}
+
+size_t Print::print(const char* text) {
+    return write((const uint8_t*)text, strlen(text));
+}
+
+size_t Print::print(char c) {
+    return write((uint8_t)c);
+}
+
+size_t Print::print(int value, int base) {
+    return print((long)value, base);
+}
+
+size_t Print::print(long value, int base) {
+    if (base == DEC && value < 0) {
+        return print('-') + printNumber((unsigned long)-value, base);
+    }
+    return printNumber((unsigned long)value, base);
+}
+
+size_t Print::println() {
+    return print("\r\n");
+}
+
+size_t Print::printNumber(unsigned long value, int base) {
+    char buffer[8 * sizeof(long) + 1];
+    char* p = &buffer[sizeof(buffer) - 1];
+    *p = '\0';
+
+    if (base < 2) base = DEC;
+    do {
+        unsigned digit = value % base;
+        *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+        value /= base;
+    } while (value);
+
+    return print(p);
+}
+
+// ---------------------------------------------------------------------------
+// HardwareSerial on a termios descriptor
+// ---------------------------------------------------------------------------
+
+static speed_t baudToSpeed(unsigned long baud) {
+    switch (baud) {
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        default:     return B0;
+    }
+}
+
+HardwareSerial::HardwareSerial(const char* device)
+    : _device(device), _fd(-1), _ownsFd(true), _rxPos(0), _rxLen(0) {
+}
+
+HardwareSerial::HardwareSerial(int fd)
+    : _device(nullptr), _fd(fd), _ownsFd(false), _rxPos(0), _rxLen(0) {
+}
+
+HardwareSerial::~HardwareSerial() {
+    end();
+}
+
+void HardwareSerial::begin(unsigned long baud) {
+    if (!_ownsFd) return;  // Wrapped descriptor, already set up
+    end();
+
+    speed_t speed = baudToSpeed(baud);
+    if (!_device || speed == B0) {
+        fprintf(stderr, "HardwareSerial: no device or unsupported baud %lu\n", baud);
+        return;
+    }
+
+    _fd = open(_device, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (_fd < 0) {
+        fprintf(stderr, "HardwareSerial: %s: %s\n", _device, strerror(errno));
+        return;
+    }
+
+    // Raw 8N1, no flow control; reads never block (VMIN = VTIME = 0)
+    struct termios tio;
+    if (tcgetattr(_fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        tcsetattr(_fd, TCSANOW, &tio);
+    }
+
+    // Ask the driver to hand over bytes immediately (FTDI, 8250...);
+    // not every driver or a pty supports it, which is fine
+    struct serial_struct serial;
+    if (ioctl(_fd, TIOCGSERIAL, &serial) == 0) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        ioctl(_fd, TIOCSSERIAL, &serial);
+    }
+
+    tcflush(_fd, TCIOFLUSH);
+}
+
+void HardwareSerial::end() {
+    if (_ownsFd && _fd >= 0) {
+        close(_fd);
+        _fd = -1;
+    }
+    _rxPos = _rxLen = 0;
+}
+
+bool HardwareSerial::waitForData(int timeoutMs) {
+    if (_fd < 0) return false;
+    if (_rxPos < _rxLen) return true;
+
+    struct pollfd pfd;
+    pfd.fd = _fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    return poll(&pfd, 1, timeoutMs) > 0 && (pfd.revents & POLLIN);
+}
+
+int HardwareSerial::available() {
+    if (_rxPos == _rxLen && _fd >= 0) {
+        // Buffer drained - take whatever the driver has in one call. Ask
+        // first: a wrapped descriptor may be blocking.
+        int count = 0;
+        _rxPos = _rxLen = 0;
+        if (ioctl(_fd, FIONREAD, &count) == 0 && count > 0) {
+            ssize_t n = ::read(_fd, _rxBuf, sizeof(_rxBuf));
+            _rxLen = n > 0 ? n : 0;
+        }
+    }
+    return _rxLen - _rxPos;
+}
+
+int HardwareSerial::read() {
+    if (!available()) return -1;
+    return _rxBuf[_rxPos++];
+}
+
+size_t HardwareSerial::write(uint8_t data) {
+    return write(&data, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (_fd < 0) return 0;
+
+    size_t written = 0;
+    while (written < size) {
+        ssize_t n = ::write(_fd, buffer + written, size - written);
+        if (n > 0) {
+            written += n;
+        } else if (n < 0 && errno != EAGAIN && errno != EINTR) {
+            break;
+        } else {
+            // Output queue full - wait until the driver takes more
+            struct pollfd pfd = { _fd, POLLOUT, 0 };
+            poll(&pfd, 1, 10);
+        }
+    }
+    return written;
+}
+
+void HardwareSerial::flush() {
+    if (_fd >= 0 && _ownsFd) {
+        tcdrain(_fd);
+    }
+}
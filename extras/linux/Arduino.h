@@ -0,0 +1,110 @@
+/*
+  Arduino.h - Minimal Arduino API for running EveryIBus on Linux
+
+  Just enough of the core for src/EveryIBus.cpp: fixed-width types,
+  millis()/micros() from CLOCK_MONOTONIC, Print, and a HardwareSerial on
+  top of a termios file descriptor (USB-UART adapter or pty).
+
+  The port is opened raw at the requested baud rate, non-blocking, with
+  the driver's low-latency flag set where supported. Input is read from
+  the descriptor in chunks into a small buffer, so parsing a frame costs
+  one read() instead of a syscall per byte. A poll()/epoll loop around
+  waitForData() can sleep until a frame starts and call update() only
+  then.
+
+  Interrupts don't exist here: noInterrupts()/interrupts() are no-ops and
+  EveryIBus must be driven from a single thread.
+*/
+
+#ifndef EVERYIBUS_LINUX_ARDUINO_H
+#define EVERYIBUS_LINUX_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define HIGH 1
+#define LOW  0
+#define INPUT  0
+#define OUTPUT 1
+
+#define DEC 10
+#define HEX 16
+
+// Strings stay in RAM on Linux
+#define F(string) (string)
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+// No GPIO: levels are only remembered, so host tests can read them back
+inline void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t data) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+
+    size_t print(const char* text);
+    size_t print(char c);
+    size_t print(unsigned char value, int base = DEC) { return printNumber(value, base); }
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC) { return printNumber(value, base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC) { return printNumber(value, base); }
+
+    size_t println();
+    template <typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+    template <typename T> size_t println(T value, int base) { size_t n = print(value, base); return n + println(); }
+
+private:
+    size_t printNumber(unsigned long value, int base);
+};
+
+class HardwareSerial : public Print {
+public:
+    // device: e.g. "/dev/ttyUSB0"; an already open descriptor can be
+    // wrapped instead (Serial uses stdout for debug output)
+    explicit HardwareSerial(const char* device = nullptr);
+    explicit HardwareSerial(int fd);
+    ~HardwareSerial();
+
+    void setDevice(const char* device) { _device = device; }
+
+    // Opens the device raw 8N1; baud must be a standard termios rate
+    void begin(unsigned long baud);
+    void end();
+    bool isOpen() const { return _fd >= 0; }
+    int fd() const { return _fd; }
+
+    // Wait up to timeoutMs (-1 = forever) for input, via poll(); true at
+    // once while buffered input is left
+    bool waitForData(int timeoutMs);
+
+    int available();
+    int read();
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    void flush();
+
+    operator bool() const { return isOpen(); }
+
+private:
+    const char* _device;
+    int _fd;
+    bool _ownsFd;
+    uint8_t _rxBuf[64];   // Read from _fd, not yet taken by read()
+    uint8_t _rxPos;
+    uint8_t _rxLen;
+};
+
+extern HardwareSerial Serial;   // stdout
+extern HardwareSerial Serial1;  // setDevice() before begin()
+
+#endif // EVERYIBUS_LINUX_ARDUINO_H
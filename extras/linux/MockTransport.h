@@ -0,0 +1,78 @@
+/*
+  MockTransport.h - In-memory transport for host tests of EveryIBus
+
+  Selected with
+    -DEVERYIBUS_TRANSPORT=MockTransport
+    -DEVERYIBUS_TRANSPORT_HEADER='"MockTransport.h"'
+  (see the ibus-test rule in the Makefile). A test feeds the bytes the
+  receiver would send into the port and reads back what the library
+  wrote. With loopback set, writes also come back on RX like through the
+  TX resistor; without it call setEchoSkip(false).
+*/
+
+#ifndef EVERYIBUS_MOCK_TRANSPORT_H
+#define EVERYIBUS_MOCK_TRANSPORT_H
+
+#include <Arduino.h>
+
+#define MOCK_PORT_BUFFER 64
+
+struct MockPort {
+    uint8_t rx[MOCK_PORT_BUFFER];      // Bytes still to be read by the library
+    uint8_t rxHead;
+    uint8_t rxTail;
+    uint8_t tx[MOCK_PORT_BUFFER];      // Bytes written by the library
+    uint8_t txLen;
+    bool loopback;                     // Written bytes are fed back to rx
+
+    MockPort() : rxHead(0), rxTail(0), txLen(0), loopback(false) {}
+
+    bool feed(const uint8_t* data, uint8_t length) {
+        if (rxHead == rxTail) rxHead = rxTail = 0;
+        if (length > MOCK_PORT_BUFFER - rxTail) return false;
+        memcpy(rx + rxTail, data, length);
+        rxTail += length;
+        return true;
+    }
+
+    void clearWritten() { txLen = 0; }
+};
+
+class MockTransport {
+public:
+    typedef MockPort Port;
+    static Port& defaultPort() {
+        static Port port;
+        return port;
+    }
+
+    MockTransport() : _port(nullptr) {}
+
+    void begin(Port& port) { _port = &port; }
+
+    bool isOpen() const { return _port != nullptr; }
+
+    int available() {
+        if (_port->rxHead == _port->rxTail) {
+            _port->rxHead = _port->rxTail = 0;   // Everything read, start over
+        }
+        return _port->rxTail - _port->rxHead;
+    }
+
+    uint8_t read() { return _port->rx[_port->rxHead++]; }
+
+    void write(const uint8_t* data, uint8_t length) {
+        // Whatever doesn't fit is lost, like a full TX buffer
+        if (length > MOCK_PORT_BUFFER - _port->txLen) length = MOCK_PORT_BUFFER - _port->txLen;
+        memcpy(_port->tx + _port->txLen, data, length);
+        _port->txLen += length;
+        if (_port->loopback) {
+            _port->feed(data, length);
+        }
+    }
+
+private:
+    Port* _port;
+};
+
+#endif // EVERYIBUS_MOCK_TRANSPORT_H
@@ -0,0 +1,145 @@
+/*
+  everyibusd.cpp - iBUS sensor daemon for Linux
+
+  Runs the unmodified EveryIBus protocol code on a USB-UART adapter (or a
+  pty) and answers receiver polls with the values other processes put in
+  the shared-memory table (see ibus_shm.h, ibus-set).
+
+  Usage: everyibusd [-d] [-n] [-a] <device>
+    -d  protocol trace on stdout (needs EVERYIBUS_DEBUG, on in the Makefile)
+    -n  no TX->RX loopback on this wiring (e.g. a pty): don't skip echoes
+    -a  dynamic addressing (share the bus with other sensors)
+
+  Each enabled table entry gets its own sensor slot in table order; a
+  changed type or a disabled entry removes the slot again.
+*/
+
+#include <Arduino.h>
+#include <EveryIBus.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ibus_shm.h"
+
+// Sleep at most this long between shared-memory checks
+#define POLL_TIMEOUT_MS 5
+
+static volatile sig_atomic_t running = 1;
+
+static void stop(int) {
+    running = 0;
+}
+
+struct Entry {
+    EveryIBusSensor handle;
+    uint8_t type;
+};
+
+static EveryIBus ibus;
+static Entry entries[IBUS_SHM_SENSORS];
+
+static void syncSensors(const IBusShm* shm) {
+    IBusShmSensor table[IBUS_SHM_SENSORS];
+    ibusShmRead(shm, table);
+
+    // One table write = one batch, so related values go live together
+#if EVERYIBUS_BATCH
+    ibus.beginBatch();
+#endif
+    for (uint8_t i = 0; i < IBUS_SHM_SENSORS; i++) {
+        Entry& entry = entries[i];
+        const IBusShmSensor& sensor = table[i];
+
+        if (entry.handle.isValid() && (!sensor.enabled || sensor.type != entry.type)) {
+            entry.handle.remove();
+            entry.handle = EveryIBusSensor();
+        }
+        if (!sensor.enabled) continue;
+#if !EVERYIBUS_WIDE_SENSORS
+        if (sensor.type >= IBUS_SENSOR_WIDE_FIRST) {
+            fprintf(stderr, "everyibusd: entry %u: 4-byte types need EVERYIBUS_WIDE_SENSORS\n", i);
+            continue;
+        }
+#endif
+
+        if (!entry.handle.isValid()) {
+            entry.handle = ibus.addSensor(sensor.type);
+            entry.type = sensor.type;
+            if (!entry.handle.isValid()) {
+                fprintf(stderr, "everyibusd: no free slot for entry %u\n", i);
+                continue;
+            }
+        }
+#if EVERYIBUS_WIDE_SENSORS
+        if (sensor.type >= IBUS_SENSOR_WIDE_FIRST) {
+            entry.handle.setWide(sensor.value);
+            continue;
+        }
+#endif
+        entry.handle.set((uint16_t)sensor.value);
+    }
+#if EVERYIBUS_BATCH
+    ibus.commitBatch();
+#endif
+}
+
+int main(int argc, char** argv) {
+    bool debug = false;
+    bool echo = true;
+    bool dynamic = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "dna")) != -1) {
+        switch (opt) {
+            case 'd': debug = true; break;
+            case 'n': echo = false; break;
+            case 'a': dynamic = true; break;
+            default:
+                fprintf(stderr, "usage: %s [-d] [-n] [-a] <device>\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-d] [-n] [-a] <device>\n", argv[0]);
+        return 2;
+    }
+
+    IBusShm* shm = ibusShmOpen(true);
+    if (!shm) return 1;
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    Serial1.setDevice(argv[optind]);
+    ibus.setDynamicAddressing(dynamic);
+    ibus.begin(Serial1);
+    if (!Serial1) return 1;
+
+#if EVERYIBUS_DEBUG
+    ibus.setDebug(debug);
+#else
+    if (debug) fprintf(stderr, "everyibusd: built without EVERYIBUS_DEBUG, -d ignored\n");
+#endif
+    ibus.setEchoSkip(echo);
+    ibus.setUpdateBudget(255);  // No control loop to share the CPU with
+
+    uint32_t sequence = shm->sequence + 1;  // Force the first sync
+    while (running) {
+        // Sleep until a poll starts; wake up regularly for new values
+        Serial1.waitForData(POLL_TIMEOUT_MS);
+        ibus.update();
+
+        if (shm->sequence != sequence && !(shm->sequence & 1)) {
+            sequence = shm->sequence;
+            syncSensors(shm);
+        }
+    }
+
+    printf("everyibusd: %lu polls, %lu responses, longest update %lu us\n",
+           (unsigned long)ibus.getPacketCount(), (unsigned long)ibus.getResponseCount(),
+           (unsigned long)ibus.getMaxUpdateMicros());
+    return 0;
+}
@@ -0,0 +1,147 @@
+/*
+  ibus-bench.cpp - Host timings for the poll -> response path
+
+  The host counterpart of examples/Benchmark: the same path timed stage
+  by stage on MockTransport, so the cost of a change shows up without a
+  board. Host times say nothing about AVR cycles; compare runs on one
+  machine only.
+
+  Stages:
+  - checksum       calculateChecksum() over a poll header
+  - validate       validatePacket() on a MEASUREMENT poll
+  - frame_parse    receive() of a 4-byte poll for an address nobody has:
+                   framing, validation and the failed slot lookup
+  - slot_lookup    slotForAddress() for an assigned address
+  - frame_build    buildMeasurementFrame() for one slot
+  - tx_write       sendPacket() of a 6-byte reply into the mock port
+  - poll_response  update() on queued MEASUREMENT polls, per poll
+
+  Each stage runs in batches; min/avg/max are nanoseconds per call over
+  the batches. Output is CSV like the sketch's, for diffing runs.
+  Run with: make -C extras/linux bench
+*/
+
+#include <stdio.h>
+#include <time.h>
+
+#include "EveryIBus.h"
+
+#define BATCHES     200
+#define BATCH_CALLS 1000
+#define QUEUED_POLLS 10     // 40 bytes in, 60 out: fits the mock buffers
+
+struct Stage {
+    const char* name;
+    double minNs;
+    double maxNs;
+    double totalNs;
+};
+
+static volatile uint16_t sink;
+
+static uint64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void record(Stage& stage, uint64_t elapsedNs, uint32_t calls) {
+    double ns = (double)elapsedNs / calls;
+    if (ns < stage.minNs) stage.minNs = ns;
+    if (ns > stage.maxNs) stage.maxNs = ns;
+    stage.totalNs += ns;
+}
+
+// Time one batch of a statement; it can use the call number n
+#define MEASURE(stage, code) do {                        \
+        uint64_t t0 = nowNs();                           \
+        for (uint32_t n = 0; n < BATCH_CALLS; n++) {     \
+            code;                                        \
+        }                                                \
+        record(stage, nowNs() - t0, BATCH_CALLS);        \
+    } while (0)
+
+class EveryIBusBench {
+public:
+    EveryIBusBench() {
+        _ibus.begin(_port);
+        _ibus.setEchoSkip(false);
+        _ibus.setUpdateBudget(QUEUED_POLLS * IBUS_MIN_FRAME_LEN);
+        _ibus.setExternalVoltage(12.41);
+        _ibus.setTemperature(21.0);
+
+        buildPoll(_poll, IBUS_CMD_MEASUREMENT, 1);
+        buildPoll(_unknownPoll, IBUS_CMD_MEASUREMENT, IBUS_MAX_ADDRESS);
+        for (uint8_t i = 0; i < QUEUED_POLLS; i++) {
+            memcpy(_queued + i * IBUS_MIN_FRAME_LEN, _poll, IBUS_MIN_FRAME_LEN);
+        }
+    }
+
+    int run() {
+        Stage stages[] = {
+            { "checksum",      1e9, 0, 0 },
+            { "validate",      1e9, 0, 0 },
+            { "frame_parse",   1e9, 0, 0 },
+            { "slot_lookup",   1e9, 0, 0 },
+            { "frame_build",   1e9, 0, 0 },
+            { "tx_write",      1e9, 0, 0 },
+            { "poll_response", 1e9, 0, 0 },
+        };
+        enum { CHECKSUM, VALIDATE, FRAME_PARSE, SLOT_LOOKUP, FRAME_BUILD, TX_WRITE, POLL_RESPONSE };
+        const uint8_t* frame = _ibus.frameFor(0);
+
+        for (uint16_t batch = 0; batch < BATCHES; batch++) {
+            MEASURE(stages[CHECKSUM], sink = EveryIBus::calculateChecksum(_poll, 2));
+            MEASURE(stages[VALIDATE], sink = EveryIBus::validatePacket(_poll));
+            MEASURE(stages[FRAME_PARSE], for (uint8_t i = 0; i < IBUS_MIN_FRAME_LEN; i++) _ibus.receive(_unknownPoll[i]));
+            MEASURE(stages[SLOT_LOOKUP], sink = _ibus.slotForAddress(1 + (n & 1)));
+            MEASURE(stages[FRAME_BUILD], _ibus.buildMeasurementFrame(n & 1));
+            MEASURE(stages[TX_WRITE], _ibus.sendPacket(frame, IBUS_MEASUREMENT_FRAME_LEN); _port.clearWritten());
+
+            // Queue a burst of polls and answer them in one update()
+            uint64_t elapsed = 0;
+            for (uint32_t n = 0; n < BATCH_CALLS / QUEUED_POLLS; n++) {
+                _port.clearWritten();
+                _port.feed(_queued, sizeof(_queued));
+                uint64_t t0 = nowNs();
+                _ibus.update();
+                elapsed += nowNs() - t0;
+            }
+            record(stages[POLL_RESPONSE], elapsed, BATCH_CALLS);
+        }
+
+        if (_ibus.getResponseCount() != (uint32_t)BATCHES * BATCH_CALLS) {
+            fprintf(stderr, "ibus-bench: %lu responses, expected %lu\n",
+                    (unsigned long)_ibus.getResponseCount(), (unsigned long)BATCHES * BATCH_CALLS);
+            return 1;
+        }
+
+        printf("# EveryIBus %s, host, %d x %d calls\n", EVERYIBUS_VERSION, BATCHES, BATCH_CALLS);
+        printf("stage,min_ns,avg_ns,max_ns,batches\n");
+        for (uint8_t i = 0; i < sizeof(stages) / sizeof(stages[0]); i++) {
+            const Stage& s = stages[i];
+            printf("%s,%.1f,%.1f,%.1f,%d\n", s.name, s.minNs, s.totalNs / BATCHES, s.maxNs, BATCHES);
+        }
+        return 0;
+    }
+
+private:
+    MockPort _port;
+    EveryIBus _ibus;
+    uint8_t _poll[IBUS_MIN_FRAME_LEN];
+    uint8_t _unknownPoll[IBUS_MIN_FRAME_LEN];
+    uint8_t _queued[QUEUED_POLLS * IBUS_MIN_FRAME_LEN];
+
+    static void buildPoll(uint8_t* frame, uint8_t command, uint8_t address) {
+        frame[0] = IBUS_MIN_FRAME_LEN;
+        frame[1] = command | address;
+        uint16_t checksum = EveryIBus::calculateChecksum(frame, 2);
+        frame[2] = checksum & 0xFF;
+        frame[3] = checksum >> 8;
+    }
+};
+
+int main() {
+    EveryIBusBench bench;
+    return bench.run();
+}
@@ -0,0 +1,306 @@
+/*
+  ibus-fuzz.cpp - Fuzz target for the iBUS parsers
+
+  Arbitrary bytes go through MockTransport into EveryIBus::update() (the
+  sensor side) and EveryIBusMaster::update() (the receiver side), mixed
+  with slot operations and clock steps taken from the same input. Built
+  with ASan/UBSan, so an out-of-range slot or address index aborts, and
+  checked after every update() call:
+    - no more bytes read than the update budget
+    - every reply of the sensor side answers a well-formed poll that was
+      fed before it, and every frame it writes is well-formed
+    - the receiver side only writes well-formed polls for addresses 1-15
+
+  Input: byte 0 = options, then operations (high 2 bits of the op byte):
+    00nnnnnn  feed the next n+1 bytes to both sides and run update()
+    01......  addSensor(next byte) on the sensor side
+    10wsssss  set slot s (0-31, out of range on purpose) to the next 2
+              bytes, 4-byte value if w
+    11mspppp  m = 0: removeSensor(slot p, mode s); m = 1: advance the
+              clock by p * 256us, then update() and publishTo()
+
+  make -C extras/linux fuzz                random inputs, g++ ASan/UBSan
+  make -C extras/linux fuzz FUZZER=libfuzzer   libFuzzer (clang++)
+  ./ibus-fuzz crash-file ...               replay inputs
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "EveryIBus.h"
+#include "EveryIBusMaster.h"
+
+// ---------------------------------------------------------------------------
+// Virtual clock and pins - time only moves when the input says so
+// ---------------------------------------------------------------------------
+
+static uint32_t clockMicros = 0;
+
+uint32_t micros() { return clockMicros; }
+uint32_t millis() { return clockMicros / 1000; }
+void delay(uint32_t ms) { clockMicros += ms * 1000; }
+
+static uint8_t pinLevels[256];
+void digitalWrite(uint8_t pin, uint8_t level) { pinLevels[pin] = level; }
+int digitalRead(uint8_t pin) { return pinLevels[pin]; }
+
+// ---------------------------------------------------------------------------
+// Checks
+// ---------------------------------------------------------------------------
+
+#define FUZZ_CHECK(condition) do { \
+    if (!(condition)) { \
+        fprintf(stderr, "%s:%d: FUZZ_CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+        abort(); \
+    } \
+} while (0)
+
+// Bytes both sides have been fed so far, for matching replies to polls
+static uint8_t fed[4096];
+static size_t fedLength;
+static size_t sensorConsumed;      // Bytes read by the sensor side
+static size_t pollsCounted;        // fed[] positions scanned for polls
+static uint16_t polls[256];        // Well-formed polls seen, by command | address
+static uint16_t replies[256];      // Replies sent, by command | address
+
+// Worked out here rather than with the library's own helpers, so a bug
+// in those can't hide itself
+static bool checksumOk(const uint8_t* frame, uint8_t length) {
+    uint16_t checksum = 0xFFFF;
+    for (uint8_t i = 0; i < length - 2; i++) checksum -= frame[i];
+    return frame[length - 2] == (checksum & 0xFF) && frame[length - 1] == (checksum >> 8);
+}
+
+static bool isPoll(const uint8_t* frame) {
+    uint8_t command = frame[1] & 0xF0;
+    return frame[0] == IBUS_MIN_FRAME_LEN && checksumOk(frame, IBUS_MIN_FRAME_LEN) &&
+           (command == IBUS_CMD_DISCOVER || command == IBUS_CMD_TYPE || command == IBUS_CMD_MEASUREMENT);
+}
+
+static void countPolls() {
+    // Every well-formed poll fully read so far, at any offset
+    while (pollsCounted + IBUS_MIN_FRAME_LEN <= sensorConsumed) {
+        const uint8_t* frame = fed + pollsCounted++;
+        if (isPoll(frame)) {
+            polls[frame[1]]++;
+        }
+    }
+}
+
+static void checkSensorOutput(MockPort& port) {
+    countPolls();
+    for (uint8_t pos = 0; pos < port.txLen;) {
+        const uint8_t* frame = port.tx + pos;
+        uint8_t length = frame[0];
+        uint8_t command = frame[1] & 0xF0;
+        uint8_t address = frame[1] & 0x0F;
+
+        FUZZ_CHECK(pos + length <= port.txLen);
+        FUZZ_CHECK(address >= 1 && address <= IBUS_MAX_ADDRESS);
+        FUZZ_CHECK(checksumOk(frame, length));
+        if (command == IBUS_CMD_DISCOVER) {
+            FUZZ_CHECK(length == IBUS_MIN_FRAME_LEN);
+        } else if (command == IBUS_CMD_TYPE) {
+            FUZZ_CHECK(length == 6);
+        } else {
+            FUZZ_CHECK(command == IBUS_CMD_MEASUREMENT);
+            FUZZ_CHECK(length == IBUS_MEASUREMENT_FRAME_LEN || length == IBUS_WIDE_FRAME_LEN);
+        }
+
+        // At most one reply per poll of that command and address
+        FUZZ_CHECK(++replies[frame[1]] <= polls[frame[1]]);
+        pos += length;
+    }
+    port.clearWritten();
+}
+
+static void checkMasterOutput(MockPort& port) {
+    FUZZ_CHECK(port.txLen % IBUS_MIN_FRAME_LEN == 0);
+    for (uint8_t pos = 0; pos < port.txLen; pos += IBUS_MIN_FRAME_LEN) {
+        FUZZ_CHECK(isPoll(port.tx + pos));
+        FUZZ_CHECK((port.tx[pos + 1] & 0x0F) >= 1);
+    }
+    port.clearWritten();
+}
+
+struct FuzzBus {
+    MockPort sensorPort;
+    MockPort masterPort;
+    EveryIBus sensor;
+    EveryIBusMaster master;
+    uint8_t budget;
+
+    void update() {
+        uint8_t before = sensorPort.rxTail - sensorPort.rxHead;
+        sensor.update();
+        uint8_t read = before - (sensorPort.rxTail - sensorPort.rxHead);
+        FUZZ_CHECK(read <= budget);
+        sensorConsumed += read;
+        checkSensorOutput(sensorPort);
+
+        before = masterPort.rxTail - masterPort.rxHead;
+        master.update();
+        FUZZ_CHECK((uint8_t)(before - (masterPort.rxTail - masterPort.rxHead)) <= budget);
+        checkMasterOutput(masterPort);
+    }
+
+    void feed(const uint8_t* data, uint8_t length) {
+        // Only what the sensor side actually gets counts for the replies
+        if (sensorPort.feed(data, length)) {
+            memcpy(fed + fedLength, data, length);
+            fedLength += length;
+        }
+        masterPort.feed(data, length);
+
+        // Bounded by the budget, so this ends; at most 64 / 1 calls
+        for (uint8_t n = 0; n < MOCK_PORT_BUFFER; n++) {
+            if (sensorPort.rxHead == sensorPort.rxTail && masterPort.rxHead == masterPort.rxTail) break;
+            update();
+        }
+    }
+};
+
+static void runInput(const uint8_t* data, size_t size) {
+    if (size < 1 || size > sizeof(fed)) return;
+
+    clockMicros = 0;
+    fedLength = 0;
+    sensorConsumed = 0;
+    pollsCounted = 0;
+    memset(polls, 0, sizeof(polls));
+    memset(replies, 0, sizeof(replies));
+
+    FuzzBus bus;
+    uint8_t options = data[0];
+    bus.budget = ((options >> 2) & 0x07) + 1;
+    bus.sensor.setDynamicAddressing(options & 0x01);
+    bus.sensor.begin(bus.sensorPort);
+    bus.sensor.setEchoSkip(options & 0x02);
+    bus.sensor.setUpdateBudget(bus.budget);
+    bus.master.begin(bus.masterPort);
+    bus.master.setEchoSkip(options & 0x02);
+    bus.master.setUpdateBudget(bus.budget);
+    bus.master.setDropMode(options & 0x20 ? IBUS_REMOVE_FAILSAFE : IBUS_REMOVE_SILENT);
+
+    size_t i = 1;
+    while (i < size) {
+        uint8_t op = data[i++];
+        switch (op >> 6) {
+            case 0: {
+                uint8_t length = (op & 0x3F) + 1;
+                if (length > size - i) length = size - i;
+                bus.feed(data + i, length);
+                i += length;
+                break;
+            }
+            case 1:
+                if (i < size) bus.sensor.addSensor(data[i++]);
+                break;
+            case 2: {
+                if (size - i < 2) return;
+                uint16_t value = data[i] | (data[i + 1] << 8);
+                i += 2;
+#if EVERYIBUS_WIDE_SENSORS
+                if (op & 0x20) {
+                    bus.sensor.setSlotWideValue(op & 0x1F, (int32_t)value << 8);
+                    break;
+                }
+#endif
+                bus.sensor.setSlotValue(op & 0x1F, value);
+                break;
+            }
+            case 3:
+                if (op & 0x20) {
+                    clockMicros += (op & 0x0F) * 256u;
+                    bus.update();
+                    bus.master.publishTo(bus.sensor);
+                } else {
+                    bus.sensor.removeSensor(op & 0x0F, (op >> 4) & 1, 0);
+                }
+                break;
+        }
+    }
+}
+
+#ifdef IBUS_FUZZ_LIBFUZZER
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    runInput(data, size);
+    return 0;
+}
+#else
+// Random input for the standalone driver. Pure noise almost never holds
+// a frame with a valid checksum, so most feeds are polls a receiver
+// could send, some of them damaged or cut at a random point.
+static size_t randomInput(uint8_t* input, size_t size) {
+    static const uint8_t commands[] = { IBUS_CMD_DISCOVER, IBUS_CMD_TYPE, IBUS_CMD_MEASUREMENT };
+    size_t length = 0;
+    input[length++] = rand();
+    for (int n = rand() % 6; n >= 0; n--) {
+        input[length++] = 0x40;
+        input[length++] = rand() % 2 ? rand() % 0x10 : rand() % 0x60;   // Sensor types, some unknown
+        input[length++] = 0x80 | (rand() % 0x40);
+        input[length++] = rand();
+        input[length++] = rand();
+    }
+
+    while (length + 3 + 64 <= size) {
+        int pick = rand() % 10;
+        if (pick < 6) {
+            uint8_t poll[IBUS_MIN_FRAME_LEN] = { IBUS_MIN_FRAME_LEN, 0, 0, 0 };
+            poll[1] = commands[rand() % 3] | (rand() % 2 ? 1 + rand() % 4 : rand() % 16);
+            uint16_t checksum = EveryIBus::calculateChecksum(poll, 2);
+            poll[2] = checksum & 0xFF;
+            poll[3] = checksum >> 8;
+            if (rand() % 8 == 0) poll[rand() % 4] ^= 1 << (rand() % 8);
+            uint8_t cut = rand() % 4 == 0 ? 1 + rand() % IBUS_MIN_FRAME_LEN : IBUS_MIN_FRAME_LEN;
+            input[length++] = cut - 1;
+            memcpy(input + length, poll, cut);
+            length += cut;
+            if (rand() % 2) input[length++] = 0xE0 | (rand() % 16);   // Line quiet for a while
+        } else if (pick == 6) {
+            uint8_t noise = rand() % 64;
+            input[length++] = noise;
+            for (int n = 0; n <= noise; n++) input[length++] = rand();
+        } else if (pick == 7) {
+            input[length++] = 0x80 | (rand() % 0x40);
+            input[length++] = rand();
+            input[length++] = rand();
+        } else if (pick == 8) {
+            input[length++] = 0xE0 | (rand() % 16);   // Clock step
+        } else {
+            input[length++] = rand() % 4 ? 0x40 : 0xC0 | (rand() % 0x20);
+            input[length++] = rand() % 0x60;
+        }
+    }
+    return length;
+}
+
+// Standalone driver: replay the given files, or run random inputs
+int main(int argc, char** argv) {
+    static uint8_t input[sizeof(fed)];
+
+    if (argc > 1) {
+        for (int n = 1; n < argc; n++) {
+            FILE* file = fopen(argv[n], "rb");
+            if (!file) {
+                perror(argv[n]);
+                return 1;
+            }
+            size_t size = fread(input, 1, sizeof(input), file);
+            fclose(file);
+            runInput(input, size);
+        }
+        return 0;
+    }
+
+    const char* env = getenv("IBUS_FUZZ_RUNS");
+    long runs = env ? atol(env) : 20000;
+    srand(1);
+    for (long run = 0; run < runs; run++) {
+        size_t size = randomInput(input, 64 + rand() % 448);
+        runInput(input, size);
+    }
+    printf("%ld inputs OK\n", runs);
+    return 0;
+}
+#endif
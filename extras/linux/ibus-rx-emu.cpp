@@ -0,0 +1,135 @@
+/*
+  ibus-rx-emu.cpp - Receiver side of the iBUS sensor bus, for testing
+
+  Polls the bus with EveryIBusMaster: DISCOVER and TYPE to find the
+  sensors, then MEASUREMENT round-robin, each poll sent as soon as the
+  previous reply is complete. The decoded values are printed once per
+  second.
+
+  Usage: ibus-rx-emu -p          create a pty and print its name
+         ibus-rx-emu <device>    poll through a real adapter
+
+  Local test without hardware:
+    ./ibus-rx-emu -p               prints e.g. /dev/pts/5
+    ./everyibusd -n /dev/pts/5
+    ./ibus-set 0:3:1241 1:1:611
+
+  Expects no echo of its own polls, i.e. a pty or a separate RX/TX pair.
+*/
+
+#include <Arduino.h>
+#include <EveryIBus.h>
+#include <EveryIBusMaster.h>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+// Longest sleep between update() calls while a reply is outstanding
+#define WAIT_TIMEOUT_MS 1
+
+static volatile sig_atomic_t running = 1;
+
+static void stop(int) {
+    running = 0;
+}
+
+static EveryIBusMaster master;
+
+static void printValue(uint8_t address) {
+    int32_t value = master.getValue(address);
+    printf("  %2u ", address);
+    switch (master.getType(address)) {
+        case IBUS_SENSOR_INTERNAL_VOLTAGE: printf("IntV  %6.2f V\n", value / 100.0); break;
+        case IBUS_SENSOR_EXTERNAL_VOLTAGE: printf("ExtV  %6.2f V\n", value / 100.0); break;
+        case IBUS_SENSOR_TEMPERATURE:      printf("Temp  %6.1f C\n", (value - 400) / 10.0); break;
+        case IBUS_SENSOR_RPM:              printf("RPM   %6d\n", value); break;
+        case IBUS_SENSOR_CURRENT:          printf("Curr  %6.2f A\n", value / 100.0); break;
+        case IBUS_SENSOR_FUEL:             printf("Fuel  %6d mAh\n", value); break;
+        case IBUS_SENSOR_CLIMB_RATE:       printf("Climb %6.2f m/s\n", (int16_t)value / 100.0); break;
+        case IBUS_SENSOR_ALTITUDE:         printf("Alt   %6.2f m\n", value / 100.0); break;
+        case IBUS_SENSOR_GPS_LAT:          printf("Lat   %.7f\n", value / 1e7); break;
+        case IBUS_SENSOR_GPS_LON:          printf("Lon   %.7f\n", value / 1e7); break;
+        default:                           printf("0x%02X  %6d\n", master.getType(address), value); break;
+    }
+}
+
+static int openPty() {
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0) {
+        perror("posix_openpt");
+        return -1;
+    }
+    printf("%s\n", ptsname(fd));
+    fflush(stdout);
+    return fd;
+}
+
+static int openDevice(const char* device) {
+    int fd = open(device, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        perror(device);
+        return -1;
+    }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        cfsetispeed(&tio, B115200);
+        cfsetospeed(&tio, B115200);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s -p | <device>\n", argv[0]);
+        return 2;
+    }
+
+    int fd = strcmp(argv[1], "-p") == 0 ? openPty() : openDevice(argv[1]);
+    if (fd < 0) return 1;
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    HardwareSerial port(fd);
+    master.begin(port);
+    master.setEchoSkip(false);
+    master.setUpdateBudget(255);
+
+    uint32_t lastPrint = millis();
+    while (running) {
+        port.waitForData(WAIT_TIMEOUT_MS);
+        master.update();
+
+        if (millis() - lastPrint >= 1000) {
+            lastPrint = millis();
+            printf("t=%lus, %lu polls, %lu replies\n", (unsigned long)(lastPrint / 1000),
+                   (unsigned long)master.getPollCount(), (unsigned long)master.getReplyCount());
+            for (uint8_t a = 1; a <= IBUS_MAX_ADDRESS; a++) {
+                if (!master.isPresent(a)) continue;
+                if (master.isFresh(a, 100)) {
+                    printValue(a);
+                } else {
+                    printf("  %2u (no reply)\n", a);
+                }
+            }
+            fflush(stdout);
+        }
+    }
+
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,65 @@
+/*
+  ibus-set.cpp - Write values into the everyibusd shared-memory table
+
+  Usage: ibus-set <entry>:<type>:<raw> ... | <entry>:off ...
+    ibus-set 0:3:1241 1:5:2350    ExtV 12.41V and current 23.50A
+    ibus-set 2:131:-1234          Altitude -12.34m (types >= 0x80 are signed 32-bit)
+    ibus-set 1:off                Remove entry 1 from the bus
+
+  All arguments are written as one update, so everyibusd publishes them
+  together.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ibus_shm.h"
+
+// Types from here up carry 32-bit values (see EveryIBus.h)
+#define IBUS_SENSOR_WIDE_FIRST 0x80
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <entry>:<type>:<raw> ... | <entry>:off ...\n", argv[0]);
+        return 2;
+    }
+
+    IBusShm* shm = ibusShmOpen(true);
+    if (!shm) return 1;
+
+    // Parse everything first so a typo doesn't leave half an update
+    IBusShmSensor updates[IBUS_SHM_SENSORS];
+    bool touched[IBUS_SHM_SENSORS] = {};
+    for (int i = 1; i < argc; i++) {
+        unsigned entry, type;
+        long value;
+        char off[4];
+        if (sscanf(argv[i], "%u:%u:%ld", &entry, &type, &value) == 3 &&
+            entry < IBUS_SHM_SENSORS && type <= 0xFF &&
+            (type >= IBUS_SENSOR_WIDE_FIRST ? value >= INT32_MIN && value <= INT32_MAX
+                                            : value >= 0 && value <= 0xFFFF)) {
+            updates[entry].type = type;
+            updates[entry].enabled = 1;
+            updates[entry].value = (int32_t)value;
+        } else if (sscanf(argv[i], "%u:%3s", &entry, off) == 2 &&
+                   entry < IBUS_SHM_SENSORS && strcmp(off, "off") == 0) {
+            updates[entry].type = 0;
+            updates[entry].enabled = 0;
+            updates[entry].value = 0;
+        } else {
+            fprintf(stderr, "ibus-set: bad argument '%s'\n", argv[i]);
+            return 2;
+        }
+        touched[entry] = true;
+    }
+
+    ibusShmWriteBegin(shm);
+    for (unsigned i = 0; i < IBUS_SHM_SENSORS; i++) {
+        if (touched[i]) {
+            shm->sensors[i] = updates[i];
+        }
+    }
+    ibusShmWriteEnd(shm);
+    return 0;
+}
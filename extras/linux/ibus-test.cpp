@@ -0,0 +1,361 @@
+/*
+  ibus-test.cpp - Host tests for the EveryIBus protocol core
+
+  Built on MockTransport.h: polls are fed into the mock port and the
+  replies read back from it. Plain asserts, no framework: every CHECK
+  that fails is printed and the exit code is the number of failures.
+  Run with: make -C extras/linux test
+*/
+
+#include <stdio.h>
+
+#include "EveryIBus.h"
+#include "EveryIBusMaster.h"
+
+static int failures = 0;
+
+#define CHECK(condition) do { \
+    if (!(condition)) { \
+        printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+        failures++; \
+    } \
+} while (0)
+
+#define ALARM_PIN 5
+
+static void buildPoll(uint8_t* frame, uint8_t command, uint8_t address) {
+    frame[0] = IBUS_MIN_FRAME_LEN;
+    frame[1] = command | address;
+    uint16_t checksum = EveryIBus::calculateChecksum(frame, 2);
+    frame[2] = checksum & 0xFF;
+    frame[3] = checksum >> 8;
+}
+
+// Feed one receiver poll (and an optional copy from another device) and
+// run update() until it is consumed
+static void poll(EveryIBus& ibus, MockPort& port, uint8_t command, uint8_t address, bool copied = false) {
+    uint8_t frame[IBUS_MIN_FRAME_LEN];
+    buildPoll(frame, command, address);
+
+    port.clearWritten();
+    port.feed(frame, sizeof(frame));
+    if (copied) {
+        port.feed(frame, sizeof(frame));
+    }
+    while (port.rxHead != port.rxTail) {
+        ibus.update();
+    }
+}
+
+static bool checksumOk(const uint8_t* frame) {
+    uint8_t length = frame[0];
+    uint16_t checksum = EveryIBus::calculateChecksum(frame, length - 2);
+    return frame[length - 2] == (checksum & 0xFF) && frame[length - 1] == (checksum >> 8);
+}
+
+static void testPollResponse() {
+    MockPort port;
+    EveryIBus ibus;
+    ibus.begin(port);
+    ibus.setEchoSkip(false);
+    ibus.setExternalVoltage(12.41);   // Slot 0, address 1
+
+    poll(ibus, port, IBUS_CMD_DISCOVER, 1);
+    CHECK(port.txLen == 4);
+    CHECK(port.tx[1] == (IBUS_CMD_DISCOVER | 1));
+
+    poll(ibus, port, IBUS_CMD_TYPE, 1);
+    CHECK(port.txLen == 6);
+    CHECK(port.tx[2] == IBUS_SENSOR_EXTERNAL_VOLTAGE);
+    CHECK(port.tx[3] == 2);
+    CHECK(checksumOk(port.tx));
+
+    poll(ibus, port, IBUS_CMD_MEASUREMENT, 1);
+    CHECK(port.txLen == IBUS_MEASUREMENT_FRAME_LEN);
+    CHECK((port.tx[2] | (port.tx[3] << 8)) == 1241);
+    CHECK(checksumOk(port.tx));
+
+    // Nobody at address 2
+    poll(ibus, port, IBUS_CMD_DISCOVER, 2);
+    CHECK(port.txLen == 0);
+    CHECK(ibus.getResponseCount() == 3);
+}
+
+#if EVERYIBUS_WIDE_SENSORS
+static void testWideResponse() {
+    MockPort port;
+    EveryIBus ibus;
+    ibus.begin(port);
+    ibus.setEchoSkip(false);
+    ibus.setAltitude(-12.34);
+
+    poll(ibus, port, IBUS_CMD_TYPE, 1);
+    CHECK(port.tx[3] == 4);
+
+    poll(ibus, port, IBUS_CMD_MEASUREMENT, 1);
+    CHECK(port.txLen == IBUS_WIDE_FRAME_LEN);
+    int32_t value = (int32_t)((uint32_t)port.tx[2] | ((uint32_t)port.tx[3] << 8) |
+                              ((uint32_t)port.tx[4] << 16) | ((uint32_t)port.tx[5] << 24));
+    CHECK(value == -1234);
+    CHECK(checksumOk(port.tx));
+}
+#endif
+
+static void testRemoveWhileAlarmed() {
+    EveryIBus ibus;
+    ibus.setAlarmPin(ALARM_PIN);
+
+    // ExtV below 10.50V raises; a value below the hysteresis band would
+    // keep a merely widened alarm active
+    EveryIBusSensor battery = ibus.addSensor(IBUS_SENSOR_EXTERNAL_VOLTAGE);
+    CHECK(battery.setAlarm(1050, IBUS_ALARM_NO_HIGH, 20));
+    battery.set(1200);
+    CHECK(!battery.isAlarmActive());
+    battery.set(0);
+    CHECK(battery.isAlarmActive());
+    CHECK(digitalRead(ALARM_PIN) == HIGH);
+
+    CHECK(battery.remove());
+    CHECK(ibus.getAlarmStatus() == 0);
+    CHECK(digitalRead(ALARM_PIN) == LOW);
+
+    // A new sensor in the same slot starts without an alarm
+    EveryIBusSensor temp = ibus.addSensor(IBUS_SENSOR_TEMPERATURE);
+    CHECK(temp.getSlot() == battery.getSlot());
+    temp.setTemperature(20);
+    CHECK(!temp.isAlarmActive());
+    CHECK(ibus.getAlarmStatus() == 0);
+}
+
+static void testRemoveFailsafeWhileAlarmed() {
+    EveryIBus ibus;
+    ibus.setAlarmPin(ALARM_PIN);
+
+    EveryIBusSensor battery = ibus.addSensor(IBUS_SENSOR_EXTERNAL_VOLTAGE);
+    battery.setAlarm(1050, IBUS_ALARM_NO_HIGH, 20);
+    battery.set(900);
+    CHECK(battery.isAlarmActive());
+
+    // The parked frame keeps answering, the alarm doesn't
+    CHECK(battery.remove(IBUS_REMOVE_FAILSAFE, 0));
+    CHECK(ibus.getAlarmStatus() == 0);
+    CHECK(digitalRead(ALARM_PIN) == LOW);
+}
+
+static uint16_t measuredValue(EveryIBus& ibus, MockPort& port, uint8_t address) {
+    poll(ibus, port, IBUS_CMD_MEASUREMENT, address);
+    return port.txLen == IBUS_MEASUREMENT_FRAME_LEN ? port.tx[2] | (port.tx[3] << 8) : 0xFFFF;
+}
+
+static void testStaleHandle() {
+    MockPort port;
+    EveryIBus ibus;
+    ibus.begin(port);
+    ibus.setEchoSkip(false);
+
+    // Slot 0 freed and reused for another type: the old handle is dead
+    EveryIBusSensor rpm = ibus.addSensor(IBUS_SENSOR_RPM);
+    rpm.set(1000);
+    CHECK(rpm.remove());
+    CHECK(!rpm.isValid());
+    EveryIBusSensor temp = ibus.addSensor(IBUS_SENSOR_TEMPERATURE);
+    CHECK(temp.getSlot() == rpm.getSlot());
+    temp.set(600);
+    rpm.set(1234);
+    CHECK(!rpm.remove());
+    CHECK(temp.isValid());
+    CHECK(measuredValue(ibus, port, 1) == 600);
+
+    // A parked slot taken over by the same type: only the new handle writes
+    CHECK(temp.remove(IBUS_REMOVE_FAILSAFE, 400));
+    EveryIBusSensor probe = ibus.addSensor(IBUS_SENSOR_TEMPERATURE);
+    CHECK(probe.getSlot() == temp.getSlot());
+    probe.set(500);
+    temp.set(700);
+    CHECK(measuredValue(ibus, port, 1) == 500);
+}
+
+static void testDynamicAddressing() {
+    MockPort port;
+    EveryIBus ibus;
+    ibus.setDynamicAddressing(true);
+    ibus.begin(port);
+    ibus.setEchoSkip(false);
+    ibus.setExternalVoltage(12.41);
+
+    // One discovery sweep 1..3 with another device at address 1
+    poll(ibus, port, IBUS_CMD_DISCOVER, 1, true);
+    delay(1);
+    ibus.update();
+    CHECK(port.txLen == 0);
+
+    // Nobody answers address 2 within the claim window: we do
+    poll(ibus, port, IBUS_CMD_DISCOVER, 2);
+    CHECK(port.txLen == 0);
+    delay(1);
+    ibus.update();
+    CHECK(port.txLen == 4 && port.tx[1] == (IBUS_CMD_DISCOVER | 2));
+    CHECK(ibus.isDiscovered());
+
+    poll(ibus, port, IBUS_CMD_TYPE, 2);
+    CHECK(port.txLen == 6 && port.tx[2] == IBUS_SENSOR_EXTERNAL_VOLTAGE);
+
+    // All our sensors have an address
+    poll(ibus, port, IBUS_CMD_DISCOVER, 3);
+    delay(1);
+    ibus.update();
+    CHECK(port.txLen == 0);
+
+    // The foreign address stays foreign on the next sweep
+    poll(ibus, port, IBUS_CMD_DISCOVER, 1);
+    delay(1);
+    ibus.update();
+    CHECK(port.txLen == 0);
+}
+
+// One third-party sensor behind the master's mock port
+struct FakeSensor {
+    uint8_t address;
+    uint8_t type;
+    uint8_t size;
+    int32_t value;
+    bool online;
+};
+
+static void reply(MockPort& port, uint8_t* frame, uint8_t length) {
+    frame[0] = length;
+    uint16_t checksum = EveryIBus::calculateChecksum(frame, length - 2);
+    frame[length - 2] = checksum & 0xFF;
+    frame[length - 1] = checksum >> 8;
+    port.feed(frame, length);
+}
+
+// Answer or time out each poll the master sends, polls times
+static void runBus(EveryIBusMaster& master, MockPort& port, const FakeSensor& sensor, uint16_t polls) {
+    master.update();
+    for (uint16_t n = 0; n < polls; n++) {
+        if (port.txLen < IBUS_MIN_FRAME_LEN) {
+            master.update();
+            continue;
+        }
+        uint8_t command = port.tx[port.txLen - 3] & 0xF0;
+        uint8_t address = port.tx[port.txLen - 3] & 0x0F;
+        port.clearWritten();
+
+        uint8_t frame[IBUS_WIDE_FRAME_LEN] = { 0, (uint8_t)(command | address) };
+        if (!sensor.online || address != sensor.address) {
+            delay(IBUS_MASTER_REPLY_TIMEOUT_US / 1000 + 1);
+        } else if (command == IBUS_CMD_DISCOVER) {
+            reply(port, frame, IBUS_MIN_FRAME_LEN);
+        } else if (command == IBUS_CMD_TYPE) {
+            frame[2] = sensor.type;
+            frame[3] = sensor.size;
+            reply(port, frame, 6);
+        } else {
+            for (uint8_t i = 0; i < sensor.size; i++) {
+                frame[2 + i] = (uint32_t)sensor.value >> (8 * i);
+            }
+            reply(port, frame, sensor.size + 4);
+        }
+        master.update();
+    }
+}
+
+static void testMasterRetypeAndDrop() {
+    MockPort masterPort, hubPort;
+    EveryIBusMaster master;
+    EveryIBus hub;
+    master.begin(masterPort);
+    master.setEchoSkip(false);
+    hub.begin(hubPort);
+    hub.setEchoSkip(false);
+
+    FakeSensor sensor = { 1, IBUS_SENSOR_TEMPERATURE, 2, 611, true };
+    runBus(master, masterPort, sensor, 20);
+    CHECK(master.getType(1) == IBUS_SENSOR_TEMPERATURE);
+    master.publishTo(hub);
+    poll(hub, hubPort, IBUS_CMD_TYPE, 1);
+    CHECK(hubPort.txLen == 6 && hubPort.tx[2] == IBUS_SENSOR_TEMPERATURE);
+
+    // Swapped for a 4-byte sensor at the same address: the 8-byte reply
+    // gets TYPE asked again, and the hub slot changes type
+    sensor.type = IBUS_SENSOR_ALTITUDE;
+    sensor.size = 4;
+    sensor.value = -1234;
+    runBus(master, masterPort, sensor, 20);
+    CHECK(master.getType(1) == IBUS_SENSOR_ALTITUDE);
+    CHECK(master.getValue(1) == -1234);
+    master.publishTo(hub);
+    poll(hub, hubPort, IBUS_CMD_TYPE, 1);
+    CHECK(hubPort.txLen == 6 && hubPort.tx[2] == IBUS_SENSOR_ALTITUDE);
+    poll(hub, hubPort, IBUS_CMD_DISCOVER, 2);
+    CHECK(hubPort.txLen == 0);   // Old temperature slot is gone
+
+    // Unplugged: after the misses the hub reports the failsafe value
+    master.setDropMode(IBUS_REMOVE_FAILSAFE, 0);
+    sensor.online = false;
+    runBus(master, masterPort, sensor, 3 * IBUS_MASTER_MAX_MISSES);
+    CHECK(!master.isPresent(1));
+    master.publishTo(hub);
+    poll(hub, hubPort, IBUS_CMD_MEASUREMENT, 1);
+#if EVERYIBUS_WIDE_SENSORS
+    CHECK(hubPort.txLen == IBUS_WIDE_FRAME_LEN);
+#endif
+    CHECK(hubPort.txLen >= IBUS_MEASUREMENT_FRAME_LEN && hubPort.tx[2] == 0 && hubPort.tx[3] == 0);
+}
+
+// A loop slower than the reply timeout finds the echo and the reply
+// waiting together, with only 4 bytes read per update()
+static void testMasterSlowLoop() {
+    MockPort port;
+    port.loopback = true;
+    EveryIBusMaster master;
+    master.begin(port);
+    master.setEchoSkip(true);
+    master.setUpdateBudget(IBUS_MIN_FRAME_LEN);
+
+    FakeSensor sensor = { 1, IBUS_SENSOR_TEMPERATURE, 2, 611, true };
+    for (uint8_t n = 0; n < 16; n++) {
+        master.update();
+        if (port.txLen >= IBUS_MIN_FRAME_LEN) {
+            uint8_t command = port.tx[1] & 0xF0;
+            uint8_t address = port.tx[1] & 0x0F;
+            uint8_t frame[IBUS_MEASUREMENT_FRAME_LEN] = { 0, port.tx[1] };
+            port.clearWritten();
+            if (address != sensor.address) {
+                // Nobody there
+            } else if (command == IBUS_CMD_DISCOVER) {
+                reply(port, frame, IBUS_MIN_FRAME_LEN);
+            } else if (command == IBUS_CMD_TYPE) {
+                frame[2] = sensor.type;
+                frame[3] = sensor.size;
+                reply(port, frame, 6);
+            } else {
+                frame[2] = sensor.value & 0xFF;
+                frame[3] = sensor.value >> 8;
+                reply(port, frame, IBUS_MEASUREMENT_FRAME_LEN);
+            }
+        }
+        delay(IBUS_MASTER_REPLY_TIMEOUT_US / 1000 + 1);
+    }
+
+    CHECK(master.isPresent(1));
+    CHECK(master.getType(1) == IBUS_SENSOR_TEMPERATURE);
+    CHECK(master.getValue(1) == 611);
+}
+
+int main() {
+    testPollResponse();
+#if EVERYIBUS_WIDE_SENSORS
+    testWideResponse();
+#endif
+    testRemoveWhileAlarmed();
+    testRemoveFailsafeWhileAlarmed();
+    testStaleHandle();
+    testDynamicAddressing();
+    testMasterRetypeAndDrop();
+    testMasterSlowLoop();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures;
+}
@@ -0,0 +1,54 @@
+/*
+  ibus_shm.cpp - Shared-memory sensor table for everyibusd
+*/
+
+#include "ibus_shm.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+IBusShm* ibusShmOpen(bool create) {
+    int fd = shm_open(IBUS_SHM_NAME, create ? (O_RDWR | O_CREAT) : O_RDWR, 0664);
+    if (fd < 0) {
+        perror("shm_open " IBUS_SHM_NAME);
+        return nullptr;
+    }
+
+    struct stat st;
+    bool fresh = fstat(fd, &st) == 0 && st.st_size < (off_t)sizeof(IBusShm);
+    if (fresh && ftruncate(fd, sizeof(IBusShm)) < 0) {
+        perror("ftruncate");
+        close(fd);
+        return nullptr;
+    }
+
+    void* mem = mmap(nullptr, sizeof(IBusShm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        perror("mmap");
+        return nullptr;
+    }
+
+    IBusShm* shm = (IBusShm*)mem;
+    if (shm->magic != IBUS_SHM_MAGIC) {
+        memset(shm, 0, sizeof(IBusShm));
+        shm->magic = IBUS_SHM_MAGIC;
+    }
+    return shm;
+}
+
+uint32_t ibusShmRead(const IBusShm* shm, IBusShmSensor* out) {
+    uint32_t before, after;
+    do {
+        before = shm->sequence;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        memcpy(out, (const void*)shm->sensors, sizeof(shm->sensors));
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        after = shm->sequence;
+    } while ((before & 1) || before != after);
+    return after;
+}
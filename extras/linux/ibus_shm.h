@@ -0,0 +1,52 @@
+/*
+  ibus_shm.h - Shared-memory sensor table for everyibusd
+
+  Producers (any process) write raw iBUS values into a POSIX shared
+  memory segment; everyibusd picks them up and answers polls with them.
+
+  Writers bracket their changes with ibusShmWriteBegin()/End(), which
+  bumps a sequence counter (odd while writing). The daemon copies the
+  table and retries if the counter moved, so a reader never publishes a
+  half-written set - all values of one write go live in one batch.
+  One writer at a time; use a lock between writers if there are several.
+*/
+
+#ifndef EVERYIBUS_IBUS_SHM_H
+#define EVERYIBUS_IBUS_SHM_H
+
+#include <stdint.h>
+
+#define IBUS_SHM_NAME      "/everyibus"
+#define IBUS_SHM_MAGIC     0x49425553u   // "IBUS"
+#define IBUS_SHM_SENSORS   15    // One per bus address
+
+struct IBusShmSensor {
+    uint8_t type;      // IBUS_SENSOR_*
+    uint8_t enabled;   // 0 = slot unused
+    int32_t value;     // Raw iBUS units (0.01V, 0.1°C + 40°C offset, ...);
+                       // 32 bits for IBUS_SENSOR_GPS_* and altitude
+};
+
+struct IBusShm {
+    uint32_t magic;
+    volatile uint32_t sequence;
+    IBusShmSensor sensors[IBUS_SHM_SENSORS];
+};
+
+// Open (and create if needed) the segment; nullptr on error
+IBusShm* ibusShmOpen(bool create);
+
+inline void ibusShmWriteBegin(IBusShm* shm) {
+    shm->sequence++;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+inline void ibusShmWriteEnd(IBusShm* shm) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    shm->sequence++;
+}
+
+// Consistent copy of the table; returns its sequence number
+uint32_t ibusShmRead(const IBusShm* shm, IBusShmSensor* out);
+
+#endif // EVERYIBUS_IBUS_SHM_H
@@ -6,183 +6,987 @@
 
 #include "EveryIBus.h"
 
+// Debug output - compiles away completely below the configured level
+#if EVERYIBUS_DEBUG >= IBUS_DEBUG_WARN
+#define IBUS_WARN(msg)               do { if (_debug) _debugOut->println(F(msg)); } while (0)
+#else
+#define IBUS_WARN(msg)               do {} while (0)
+#endif
+
+#if EVERYIBUS_DEBUG >= IBUS_DEBUG_TRACE
+#define IBUS_TRACE(msg)              do { if (_debug) _debugOut->print(F(msg)); } while (0)
+#define IBUS_TRACE_VALUE(msg, value) do { if (_debug) { _debugOut->print(F(msg)); _debugOut->print(value); } } while (0)
+#define IBUS_TRACE_HEX(data, length) do { if (_debug) debugPrintHex(data, length); } while (0)
+#define IBUS_TRACE_END()             do { if (_debug) _debugOut->println(); } while (0)
+#else
+#define IBUS_TRACE(msg)              do {} while (0)
+#define IBUS_TRACE_VALUE(msg, value) do {} while (0)
+#define IBUS_TRACE_HEX(data, length) do {} while (0)
+#define IBUS_TRACE_END()             do {} while (0)
+#endif
+
 EveryIBus::EveryIBus() {
-    _serial = nullptr;
     _currentSensorIndex = 0;
     _anyDiscovered = false;
     _packetCount = 0;
     _responseCount = 0;
+    _rxLen = 0;
+    _echoSkip = 0;
+    _skipEcho = true;
+    _byteBudget = EVERYIBUS_UPDATE_BUDGET;
+    _lastRxMicros = 0;
+    _maxUpdateMicros = 0;
+#if EVERYIBUS_STALENESS
+    _staleCount = 0;
+#endif
+#if EVERYIBUS_ALARMS
+    _alarmStatus = 0;
+    _alarmCallback = nullptr;
+    _alarmPin = 0xFF;
+    _alarmPinActiveHigh = true;
+#endif
+#if EVERYIBUS_DEBUG
     _debug = false;
+    _debugOut = &Serial;
+#endif
+    _dynamicAddressing = false;
+    _foreignAddresses = 0;
+    _freeAddresses = 0;
+    _pendingAddress = 0;
+    _pendingSince = 0;
+    _slotHook = nullptr;
+    _slotHookContext = nullptr;
+    _voltageSlot = IBUS_NO_SLOT;
+    _currentSlot = IBUS_NO_SLOT;
+#if EVERYIBUS_BATCH
+    _batching = false;
+    _batchMask = 0;
+    _frontMask = 0;
+#endif
+    _reportConsumption = false;
+    resetConsumption();
     
     // Initialize all sensors as unused
     for (int i = 0; i < MAX_SENSORS; i++) {
         _sensors[i].type = 0xFF;  // Invalid type
         _sensors[i].value = 0;
+#if EVERYIBUS_WIDE_SENSORS
+        _sensors[i].valueHigh = 0;
+#endif
         _sensors[i].hasValue = false;
+        _sensors[i].parked = false;
+        _sensors[i].address = 0;
+        _sensors[i].generation = 0;
+    }
+    
+    for (int i = 0; i <= IBUS_MAX_ADDRESS; i++) {
+        _addressMap[i] = IBUS_NO_SLOT;
     }
 }
 
-void EveryIBus::begin(HardwareSerial& serial) {
-    _serial = &serial;
-    
-    // Initialize serial at iBUS standard baud rate
-    _serial->begin(115200);
+void EveryIBus::begin(Transport::Port& port) {
+    // Opens the port at the iBUS standard baud rate
+    _port.begin(port);
     
     // Clear any initial garbage
     delay(100);
     clearSerialBuffer();
     
-    if (_debug) {
-        Serial.println(F("EveryIBus: Multi-sensor mode initialized"));
+    IBUS_TRACE("EveryIBus: Multi-sensor mode initialized");
+    IBUS_TRACE_END();
+}
+
+void EveryIBus::setDynamicAddressing(bool enable) {
+    _dynamicAddressing = enable;
+    _foreignAddresses = 0;
+    _freeAddresses = 0;
+    _pendingAddress = 0;
+    
+    for (int i = 0; i <= IBUS_MAX_ADDRESS; i++) {
+        _addressMap[i] = IBUS_NO_SLOT;
+    }
+    
+    // Static mode: slot N answers address N+1 as soon as it has a value.
+    // Dynamic mode: addresses are claimed again during discovery.
+    for (int i = 0; i < MAX_SENSORS; i++) {
+        _sensors[i].address = 0;
+        if (!enable && _sensors[i].hasValue) {
+            assignAddress(i, i + 1);
+        }
     }
 }
 
 void EveryIBus::update() {
-    if (!_serial) return;
+    if (!_port.isOpen()) return;
+    
+    uint32_t start = micros();
     
-    // Check for incoming packets
-    if (_serial->available() >= 4) {
-        handlePacket();
+    // Bounded work per call - whatever is left waits for the next call
+    uint8_t budget = _byteBudget;
+    while (budget && _port.available()) {
+        receive(_port.read());
+        budget--;
+    }
+    
+    uint32_t now = micros();
+    if (budget != _byteBudget) {
+        _lastRxMicros = now;
+    } else if ((_rxLen || _echoSkip) && now - _lastRxMicros > IBUS_FRAME_GAP_US) {
+        // Line went quiet mid-frame - drop the fragment and resync
+        _rxLen = 0;
+        _echoSkip = 0;
+    }
+    
+    // Nothing came back to a DISCOVER of a free address in time
+    if (_pendingAddress && !_rxLen && !_port.available() &&
+        now - _pendingSince > IBUS_DISCOVERY_CLAIM_US) {
+        claimPendingAddress();
+    }
+    
+    if (now - start > _maxUpdateMicros) {
+        _maxUpdateMicros = now - start;
     }
 }
 
 // Simple API functions - convert real-world units to iBUS format
 void EveryIBus::setInternalVoltage(float voltage) {
-    uint16_t rawValue = (uint16_t)(voltage * 100.0f); // Convert to 0.01V units
-    setSensorValue(IBUS_SENSOR_INTERNAL_VOLTAGE, rawValue);
+    setSensorValue(IBUS_SENSOR_INTERNAL_VOLTAGE, voltageToRaw(voltage));
 }
 
 void EveryIBus::setExternalVoltage(float voltage) {
-    uint16_t rawValue = (uint16_t)(voltage * 100.0f); // Convert to 0.01V units
-    setSensorValue(IBUS_SENSOR_EXTERNAL_VOLTAGE, rawValue);
+    setSensorValue(IBUS_SENSOR_EXTERNAL_VOLTAGE, voltageToRaw(voltage));
 }
 
 void EveryIBus::setTemperature(float tempC) {
-    // iBUS temperature: 0.1°C units where 0 = -40°C
-    // So 21.12°C = (21.12 + 40) * 10 = 611.2 ≈ 611
-    uint16_t rawValue = (uint16_t)((tempC + 40.0f) * 10.0f);
-    setSensorValue(IBUS_SENSOR_TEMPERATURE, rawValue);
+    setSensorValue(IBUS_SENSOR_TEMPERATURE, temperatureToRaw(tempC));
 }
 
 void EveryIBus::setRPM(uint16_t rpm) {
     setSensorValue(IBUS_SENSOR_RPM, rpm);
 }
 
+void EveryIBus::setCurrent(float amps) {
+    setSensorValue(IBUS_SENSOR_CURRENT, currentToRaw(amps));
+}
+
+void EveryIBus::setCellVoltage(float voltage) {
+    setSensorValue(IBUS_SENSOR_CELL_VOLTAGE, voltageToRaw(voltage));
+}
+
+void EveryIBus::setHeading(float degrees) {
+    setSensorValue(IBUS_SENSOR_HEADING, (uint16_t)degrees);
+}
+
+void EveryIBus::setClimbRate(float metersPerSecond) {
+    // Two's complement in the 16-bit field
+    setSensorValue(IBUS_SENSOR_CLIMB_RATE, (uint16_t)(int16_t)(metersPerSecond * 100.0f));
+}
+
+#if EVERYIBUS_WIDE_SENSORS
+void EveryIBus::setAltitude(float meters) {
+    setWideValue(IBUS_SENSOR_ALTITUDE, (int32_t)(meters * 100.0f));
+}
+
+void EveryIBus::setWideValue(uint8_t sensorType, int32_t value) {
+    int8_t index = findSensorIndex(sensorType);
+    if (index == -1) {
+        index = allocateSensor(sensorType);
+    }
+    
+    if (index == -1) {
+        IBUS_WARN("EveryIBus: Warning - No free sensor slots");
+        return;
+    }
+    
+    storeWideValue(index, value);
+}
+
+void EveryIBus::setSlotWideValue(uint8_t slot, int32_t value) {
+    if (!isSlotInUse(slot)) return;
+    
+    storeWideValue(slot, value);
+}
+
+void EveryIBus::storeWideValue(uint8_t index, int32_t value) {
+    // Straight through - the filter and alarm stages work on 16 bits
+    _sensors[index].value = (uint16_t)value;
+    _sensors[index].valueHigh = (uint16_t)((uint32_t)value >> 16);
+    commitValue(index);
+}
+#endif
+
+void EveryIBus::setInternalVoltage(uint8_t slot, float voltage) {
+    setSlotValue(slot, voltageToRaw(voltage));
+}
+
+void EveryIBus::setExternalVoltage(uint8_t slot, float voltage) {
+    setSlotValue(slot, voltageToRaw(voltage));
+}
+
+void EveryIBus::setTemperature(uint8_t slot, float tempC) {
+    setSlotValue(slot, temperatureToRaw(tempC));
+}
+
+void EveryIBus::setRPM(uint8_t slot, uint16_t rpm) {
+    setSlotValue(slot, rpm);
+}
+
+void EveryIBus::setCurrent(uint8_t slot, float amps) {
+    setSlotValue(slot, currentToRaw(amps));
+}
+
+void EveryIBus::resetConsumption() {
+    _hasCurrentSample = false;
+    _batteryVoltage = 0;
+    _current = 0;
+    _lastCurrentMillis = 0;
+    _chargeRemainder = 0;
+    _energyRemainder = 0;
+    _consumedMah = 0;
+    _energyMilliWh = 0;
+}
+
+uint32_t EveryIBus::getPower() const {
+    // 0.01V * 0.01A = 0.0001W, so divide by 100 for 0.01W units
+    return ((uint32_t)_batteryVoltage * _current) / 100;
+}
+
+uint16_t EveryIBus::voltageToRaw(float voltage) {
+    return (uint16_t)(voltage * 100.0f); // Convert to 0.01V units
+}
+
+uint16_t EveryIBus::temperatureToRaw(float tempC) {
+    // iBUS temperature: 0.1°C units where 0 = -40°C
+    // So 21.12°C = (21.12 + 40) * 10 = 611.2 ≈ 611
+    return (uint16_t)((tempC + 40.0f) * 10.0f);
+}
+
+uint16_t EveryIBus::currentToRaw(float amps) {
+    return (uint16_t)(amps * 100.0f); // Convert to 0.01A units
+}
+
 void EveryIBus::setSensorValue(uint8_t sensorType, uint16_t rawValue) {
     // Find existing sensor or create new one
     int8_t index = findSensorIndex(sensorType);
+    if (index == -1) {
+        index = allocateSensor(sensorType);
+    }
     
     if (index == -1) {
-        // Find empty slot
-        for (int i = 0; i < MAX_SENSORS; i++) {
-            if (!_sensors[i].hasValue) {
-                _sensors[i].type = sensorType;
-                _sensors[i].value = rawValue;
-                _sensors[i].hasValue = true;
-                
-                if (_debug) {
-                    Serial.print(F("EveryIBus: Added sensor type "));
-                    Serial.print(sensorType);
-                    Serial.print(F(" at index "));
-                    Serial.println(i);
-                }
-                return;
-            }
+        // Computed sensors still see the sample
+        feedComputedSensors(sensorType, rawValue);
+        IBUS_WARN("EveryIBus: Warning - No free sensor slots");
+        return;
+    }
+    
+    storeValue(index, rawValue);
+}
+
+EveryIBusSensor EveryIBus::addSensor(uint8_t sensorType) {
+    int8_t index = allocateSensor(sensorType);
+    if (index == -1) {
+        return EveryIBusSensor();
+    }
+    return EveryIBusSensor(this, index);
+}
+
+void EveryIBus::setSlotValue(uint8_t slot, uint16_t rawValue) {
+    if (!isSlotInUse(slot)) return;
+    
+    storeValue(slot, rawValue);
+}
+
+bool EveryIBus::removeSensor(uint8_t slot, uint8_t mode, uint16_t failsafeValue) {
+    if (slot >= MAX_SENSORS || _sensors[slot].type == 0xFF) return false;
+    
+    Sensor& sensor = _sensors[slot];
+    uint8_t sensorType = sensor.type;
+    
+#if EVERYIBUS_ALARMS
+    // A removed sensor can't hold an alarm, whatever its last value was
+    sensor.alarmLow = IBUS_ALARM_NO_LOW;
+    sensor.alarmHigh = IBUS_ALARM_NO_HIGH;
+    if (sensor.alarmActive) {
+        setAlarmState(slot, false);
+    }
+#endif
+    
+    // Handles to the removed sensor stop working, also once the slot is reused
+    sensor.generation++;
+    
+    // One step as seen from update(), even when it runs in an interrupt
+    noInterrupts();
+    if (mode == IBUS_REMOVE_FAILSAFE && sensor.hasValue) {
+        // Frozen frame on the same address until the slot is taken over
+        sensor.parked = true;
+        sensor.value = failsafeValue;
+#if EVERYIBUS_WIDE_SENSORS
+        sensor.valueHigh = 0;
+#endif
+#if EVERYIBUS_STALENESS
+        sensor.maxAge = 0;
+        sensor.stale = false;
+#endif
+        buildMeasurementFrame(slot);
+    } else {
+        if (sensor.address) {
+            _addressMap[sensor.address] = IBUS_NO_SLOT;
         }
-        
-        if (_debug) {
-            Serial.println(F("EveryIBus: Warning - No free sensor slots"));
+        sensor.type = 0xFF;
+        sensor.hasValue = false;
+        sensor.parked = false;
+        sensor.address = 0;
+    }
+    interrupts();
+    notifySlot(slot);
+    
+    // Hand the computed sensors to the next slot of the type, if any
+    if (slot == _voltageSlot || slot == _currentSlot) {
+        int8_t next = findSensorIndex(sensorType);
+        if (slot == _voltageSlot) {
+            _voltageSlot = next == -1 ? IBUS_NO_SLOT : next;
+        } else {
+            _currentSlot = next == -1 ? IBUS_NO_SLOT : next;
         }
+    }
+    return true;
+}
+
+void EveryIBus::feedComputedSensors(uint8_t sensorType, uint16_t rawValue) {
+    // Feed the computed sensors from the samples they depend on
+    if (sensorType == IBUS_SENSOR_EXTERNAL_VOLTAGE) {
+        _batteryVoltage = rawValue;
+    } else if (sensorType == IBUS_SENSOR_CURRENT) {
+        integrateCurrent(rawValue);
+    }
+}
+
+void EveryIBus::storeValue(uint8_t index, uint16_t rawValue) {
+    uint8_t sensorType = _sensors[index].type;
+    
+    if (_sensors[index].hasValue) {
+        rawValue = filterValue(index, rawValue);
     } else {
+        primeFilters(index, rawValue);
+    }
+    
+    // Only the first slot of a type drives consumption and power
+    if (index == _voltageSlot || index == _currentSlot) {
+        feedComputedSensors(sensorType, rawValue);
+    }
+    
+    _sensors[index].value = rawValue;
+#if EVERYIBUS_WIDE_SENSORS
+    _sensors[index].valueHigh = 0;
+#endif
+#if EVERYIBUS_ALARMS
+    evaluateAlarm(index);
+#endif
+    
+    commitValue(index);
+}
+
+void EveryIBus::commitValue(uint8_t index) {
+#if EVERYIBUS_STALENESS
+    _sensors[index].updatedAt = millis();
+    _sensors[index].stale = false;
+#endif
+    
+#if EVERYIBUS_BATCH
+    if (_batching) {
+        // Goes live in commitBatch()
+        _batchMask |= (1u << index);
+        return;
+    }
+#endif
+    
+    publishSlot(index);
+}
+
+void EveryIBus::publishSlot(uint8_t index) {
+    if (_sensors[index].hasValue) {
         // Update existing sensor
-        _sensors[index].value = rawValue;
+        buildMeasurementFrame(index);
+    } else {
+        // First value - the sensor starts answering polls
+        _sensors[index].hasValue = true;
+        
+        if (_dynamicAddressing) {
+            // Address (and frame) assigned when discovery claims one
+            _sensors[index].address = 0;
+        } else {
+            assignAddress(index, index + 1);
+        }
+    }
+    notifySlot(index);
+}
+
+#if EVERYIBUS_BATCH
+void EveryIBus::commitBatch() {
+    if (!_batching) return;
+    _batching = false;
+    
+    // Build the staged frames next to the live ones...
+    uint16_t swap = 0;
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        if (!(_batchMask & (1u << i))) continue;
+        if (_sensors[i].hasValue && _sensors[i].address && !_sensors[i].parked) {
+            buildMeasurementFrame(i, true);
+            swap |= (1u << i);
+        }
+    }
+    
+    // ...and make all of them live in one step
+    noInterrupts();
+    _frontMask ^= swap;
+    interrupts();
+    
+    // Sensors that got their first value start answering now
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        if (swap & (1u << i)) {
+            notifySlot(i);
+        } else if ((_batchMask & (1u << i)) && _sensors[i].type != 0xFF && !_sensors[i].parked) {
+            publishSlot(i);
+        }
+    }
+    _batchMask = 0;
+}
+#endif
+
+uint8_t* EveryIBus::frameFor(uint8_t index, bool back) {
+#if EVERYIBUS_BATCH
+    // Two buffers per slot: polls are answered from the front one
+    return _sensors[index].frame[((_frontMask >> index) & 1) ^ (back ? 1 : 0)];
+#else
+    (void)back;
+    return _sensors[index].frame;
+#endif
+}
+
+void EveryIBus::buildMeasurementFrame(uint8_t index, bool back) {
+    // Build the response once on set so a poll only has to copy it out
+    uint8_t* frame = frameFor(index, back);
+    uint8_t length = IBUS_MEASUREMENT_FRAME_LEN;
+    uint16_t value = _sensors[index].value;
+#if EVERYIBUS_WIDE_SENSORS
+    uint16_t valueHigh = _sensors[index].valueHigh;
+#endif
+    
+#if EVERYIBUS_STALENESS
+    if (_sensors[index].stale) {
+        value = _sensors[index].failsafeValue;
+#if EVERYIBUS_WIDE_SENSORS
+        valueHigh = 0;
+#endif
+    }
+#endif
+    
+    frame[1] = IBUS_CMD_MEASUREMENT | _sensors[index].address; // Command + address
+    frame[2] = value & 0xFF;                      // Value low byte
+    frame[3] = (value >> 8) & 0xFF;               // Value high byte
+#if EVERYIBUS_WIDE_SENSORS
+    if (_sensors[index].type >= IBUS_SENSOR_WIDE_FIRST) {
+        frame[4] = valueHigh & 0xFF;
+        frame[5] = (valueHigh >> 8) & 0xFF;
+        length = IBUS_WIDE_FRAME_LEN;
+    }
+#endif
+    frame[0] = length;                            // Packet length
+    
+    uint16_t checksum = calculateChecksum(frame, length - 2);
+    frame[length - 2] = checksum & 0xFF;
+    frame[length - 1] = (checksum >> 8) & 0xFF;
+}
+
+void EveryIBus::integrateCurrent(uint16_t current) {
+    uint32_t now = millis();
+    
+    if (_hasCurrentSample) {
+        uint32_t elapsed = now - _lastCurrentMillis;
+        if (elapsed > IBUS_MAX_INTEGRATION_MS) {
+            elapsed = IBUS_MAX_INTEGRATION_MS;
+        }
+        
+        // Trapezoid between the previous and this sample
+        uint32_t avgCurrent = ((uint32_t)_current + current) / 2;          // 0.01A
+        uint32_t avgPower = ((uint32_t)_batteryVoltage * avgCurrent) / 1000; // 0.1W
+        
+        // 1mAh = 360000 * 0.01A*ms and 1mWh = 36000 * 0.1W*ms
+        _chargeRemainder += avgCurrent * elapsed;
+        if (_chargeRemainder >= 360000UL) {
+            _consumedMah += _chargeRemainder / 360000UL;
+            _chargeRemainder %= 360000UL;
+        }
+        
+        // Power can reach 4.3e6 * 0.1W, so integrate in steps short
+        // enough that the product still fits in 32 bits
+        while (elapsed) {
+            uint32_t step = elapsed > IBUS_INTEGRATION_STEP_MS ? IBUS_INTEGRATION_STEP_MS : elapsed;
+            elapsed -= step;
+            
+            _energyRemainder += avgPower * step;
+            if (_energyRemainder >= 36000UL) {
+                _energyMilliWh += _energyRemainder / 36000UL;
+                _energyRemainder %= 36000UL;
+            }
+        }
+    }
+    
+    _current = current;
+    _lastCurrentMillis = now;
+    _hasCurrentSample = true;
+    
+    if (_reportConsumption) {
+        setSensorValue(IBUS_SENSOR_FUEL, _consumedMah > 0xFFFF ? 0xFFFF : (uint16_t)_consumedMah);
     }
 }
 
 int8_t EveryIBus::findSensorIndex(uint8_t sensorType) {
     for (int i = 0; i < MAX_SENSORS; i++) {
-        if (_sensors[i].hasValue && _sensors[i].type == sensorType) {
+        if (_sensors[i].type == sensorType && !_sensors[i].parked) {
             return i;
         }
     }
     return -1; // Not found
 }
 
-uint8_t EveryIBus::getNextAvailableAddress() {
-    // Return address 1-4 based on how many sensors we have
-    uint8_t count = 0;
+int8_t EveryIBus::allocateSensor(uint8_t sensorType) {
+    // A parked slot of the same type is taken over first - it keeps its
+    // address, so the receiver sees the new source without a gap
+    int8_t index = -1;
     for (int i = 0; i < MAX_SENSORS; i++) {
-        if (_sensors[i].hasValue) {
-            count++;
+        if (_sensors[i].parked && _sensors[i].type == sensorType) {
+            index = i;
+            break;
+        }
+    }
+    
+    // Otherwise reserve an empty slot - it answers polls once it has a value
+    if (index == -1) {
+        for (int i = 0; i < MAX_SENSORS; i++) {
+            if (_sensors[i].type == 0xFF) {
+                index = i;
+                break;
+            }
+        }
+        if (index == -1) return -1; // No free slot
+        
+        _sensors[index].type = sensorType;
+        _sensors[index].hasValue = false;
+        _sensors[index].address = 0;
+    }
+    
+    Sensor& sensor = _sensors[index];
+    sensor.parked = false;
+    
+    // Keep the computed-sensor inputs on the first slot of their type
+    if (sensorType == IBUS_SENSOR_EXTERNAL_VOLTAGE && index < _voltageSlot) {
+        _voltageSlot = index;
+    } else if (sensorType == IBUS_SENSOR_CURRENT && index < _currentSlot) {
+        _currentSlot = index;
+    }
+    
+#if EVERYIBUS_FILTER_MEDIAN
+    sensor.median = false;
+#endif
+#if EVERYIBUS_FILTER_EMA
+    sensor.emaShift = 0;
+#endif
+#if EVERYIBUS_FILTER_SLEW
+    sensor.slewLimit = 0;
+#endif
+#if EVERYIBUS_ALARMS
+    sensor.alarmLow = IBUS_ALARM_NO_LOW;
+    sensor.alarmHigh = IBUS_ALARM_NO_HIGH;
+    sensor.alarmHysteresis = 0;
+    sensor.alarmActive = false;
+    if (_alarmStatus & (1u << index)) {
+        // Nothing of the previous sensor carries over to the new one
+        _alarmStatus &= ~(1u << index);
+        updateAlarmPin();
+    }
+#endif
+#if EVERYIBUS_STALENESS
+    sensor.maxAge = 0;
+    sensor.stale = false;
+#endif
+    
+    IBUS_TRACE_VALUE("EveryIBus: Added sensor type ", sensorType);
+    IBUS_TRACE_VALUE(" at index ", index);
+    IBUS_TRACE_END();
+    return index;
+}
+
+// ---------------------------------------------------------------------------
+// Filter stages - constant time per sample, state lives in the sensor slot
+// ---------------------------------------------------------------------------
+
+#if EVERYIBUS_FILTER_MEDIAN
+bool EveryIBus::setMedianFilter(uint8_t sensorType, bool enable) {
+    int8_t index = findSensorIndex(sensorType);
+    if (index == -1) index = allocateSensor(sensorType);
+    return index != -1 && setSlotMedianFilter(index, enable);
+}
+
+bool EveryIBus::setSlotMedianFilter(uint8_t slot, bool enable) {
+    if (!isSlotInUse(slot)) return false;
+    
+    _sensors[slot].median = enable;
+    primeFilters(slot, _sensors[slot].value);
+    return true;
+}
+#endif
+
+#if EVERYIBUS_FILTER_EMA
+bool EveryIBus::setEMAFilter(uint8_t sensorType, uint8_t shift) {
+    int8_t index = findSensorIndex(sensorType);
+    if (index == -1) index = allocateSensor(sensorType);
+    return index != -1 && setSlotEMAFilter(index, shift);
+}
+
+bool EveryIBus::setSlotEMAFilter(uint8_t slot, uint8_t shift) {
+    if (!isSlotInUse(slot) || shift > 15) return false;
+    
+    _sensors[slot].emaShift = shift;
+    primeFilters(slot, _sensors[slot].value);
+    return true;
+}
+#endif
+
+#if EVERYIBUS_FILTER_SLEW
+bool EveryIBus::setSlewLimit(uint8_t sensorType, uint16_t maxStep) {
+    int8_t index = findSensorIndex(sensorType);
+    if (index == -1) index = allocateSensor(sensorType);
+    return index != -1 && setSlotSlewLimit(index, maxStep);
+}
+
+bool EveryIBus::setSlotSlewLimit(uint8_t slot, uint16_t maxStep) {
+    if (!isSlotInUse(slot)) return false;
+    
+    _sensors[slot].slewLimit = maxStep;
+    return true;
+}
+#endif
+
+#if EVERYIBUS_STALENESS
+bool EveryIBus::setMaxAge(uint8_t sensorType, uint16_t maxAgeMs, uint8_t mode, uint16_t failsafeValue) {
+    int8_t index = findSensorIndex(sensorType);
+    if (index == -1) index = allocateSensor(sensorType);
+    return index != -1 && setSlotMaxAge(index, maxAgeMs, mode, failsafeValue);
+}
+
+bool EveryIBus::setSlotMaxAge(uint8_t slot, uint16_t maxAgeMs, uint8_t mode, uint16_t failsafeValue) {
+    if (!isSlotInUse(slot)) return false;
+    
+    _sensors[slot].maxAge = maxAgeMs;
+    _sensors[slot].staleMode = mode;
+    _sensors[slot].failsafeValue = failsafeValue;
+    _sensors[slot].updatedAt = millis();  // Age counts from now
+    return true;
+}
+#endif
+
+#if EVERYIBUS_ALARMS
+bool EveryIBus::setAlarm(uint8_t sensorType, uint16_t low, uint16_t high, uint16_t hysteresis) {
+    int8_t index = findSensorIndex(sensorType);
+    if (index == -1) index = allocateSensor(sensorType);
+    return index != -1 && setSlotAlarm(index, low, high, hysteresis);
+}
+
+bool EveryIBus::setSlotAlarm(uint8_t slot, uint16_t low, uint16_t high, uint16_t hysteresis) {
+    if (!isSlotInUse(slot)) return false;
+    
+    _sensors[slot].alarmLow = low;
+    _sensors[slot].alarmHigh = high;
+    _sensors[slot].alarmHysteresis = hysteresis;
+    
+    if (_sensors[slot].hasValue) {
+        evaluateAlarm(slot);
+    }
+    return true;
+}
+
+void EveryIBus::setAlarmPin(uint8_t pin, bool activeHigh) {
+    _alarmPin = pin;
+    _alarmPinActiveHigh = activeHigh;
+    pinMode(pin, OUTPUT);
+    updateAlarmPin();
+}
+
+void EveryIBus::updateAlarmPin() {
+    if (_alarmPin != 0xFF) {
+        digitalWrite(_alarmPin, (_alarmStatus != 0) == _alarmPinActiveHigh ? HIGH : LOW);
+    }
+}
+
+bool EveryIBus::isAlarmActive(uint8_t sensorType) {
+    int8_t index = findSensorIndex(sensorType);
+    return index != -1 && isSlotAlarmActive(index);
+}
+
+void EveryIBus::evaluateAlarm(uint8_t index) {
+    Sensor& sensor = _sensors[index];
+    uint32_t value = sensor.value;
+    bool active;
+    
+    if (!sensor.alarmActive) {
+        active = value < sensor.alarmLow || value > sensor.alarmHigh;
+    } else {
+        // Must come back inside the limits by the hysteresis to clear
+        active = value < (uint32_t)sensor.alarmLow + sensor.alarmHysteresis ||
+                 value + sensor.alarmHysteresis > sensor.alarmHigh;
+    }
+    
+    if (active != sensor.alarmActive) {
+        setAlarmState(index, active);
+    }
+}
+
+void EveryIBus::setAlarmState(uint8_t index, bool active) {
+    // Transition - status, pin and callback only change here
+    _sensors[index].alarmActive = active;
+    if (active) {
+        _alarmStatus |= (1u << index);
+    } else {
+        _alarmStatus &= ~(1u << index);
+    }
+    updateAlarmPin();
+    
+    if (_alarmCallback) {
+        _alarmCallback(index, _sensors[index].type, active);
+    }
+}
+#endif
+
+void EveryIBus::primeFilters(uint8_t index, uint16_t rawValue) {
+    // Start every stage from the given value instead of ramping up from 0
+#if EVERYIBUS_FILTER_MEDIAN
+    for (uint8_t i = 0; i < EVERYIBUS_MEDIAN_SIZE; i++) {
+        _sensors[index].medianWindow[i] = rawValue;
+    }
+    _sensors[index].medianPos = 0;
+#endif
+#if EVERYIBUS_FILTER_EMA
+    _sensors[index].emaAccum = (uint32_t)rawValue << _sensors[index].emaShift;
+#endif
+    (void)index;
+    (void)rawValue;
+}
+
+uint16_t EveryIBus::filterValue(uint8_t index, uint16_t rawValue) {
+    Sensor& sensor = _sensors[index];
+    (void)sensor;
+    
+#if EVERYIBUS_FILTER_MEDIAN
+    if (sensor.median) {
+        sensor.medianWindow[sensor.medianPos] = rawValue;
+        if (++sensor.medianPos >= EVERYIBUS_MEDIAN_SIZE) {
+            sensor.medianPos = 0;
+        }
+        
+        // Insertion sort of a fixed, tiny window
+        uint16_t sorted[EVERYIBUS_MEDIAN_SIZE];
+        for (uint8_t i = 0; i < EVERYIBUS_MEDIAN_SIZE; i++) {
+            uint16_t v = sensor.medianWindow[i];
+            uint8_t j = i;
+            while (j > 0 && sorted[j - 1] > v) {
+                sorted[j] = sorted[j - 1];
+                j--;
+            }
+            sorted[j] = v;
+        }
+        rawValue = sorted[EVERYIBUS_MEDIAN_SIZE / 2];
+    }
+#endif
+    
+#if EVERYIBUS_FILTER_EMA
+    if (sensor.emaShift) {
+        // acc = acc - acc/2^k + x  ->  y = acc/2^k
+        sensor.emaAccum = sensor.emaAccum - (sensor.emaAccum >> sensor.emaShift) + rawValue;
+        rawValue = (uint16_t)(sensor.emaAccum >> sensor.emaShift);
+    }
+#endif
+    
+#if EVERYIBUS_FILTER_SLEW
+    if (sensor.slewLimit) {
+        uint16_t previous = sensor.value;
+        if (rawValue > previous && rawValue - previous > sensor.slewLimit) {
+            rawValue = previous + sensor.slewLimit;
+        } else if (rawValue < previous && previous - rawValue > sensor.slewLimit) {
+            rawValue = previous - sensor.slewLimit;
         }
     }
-    return count; // This will be 1-4 for the next sensor to be discovered
+#endif
+    
+    return rawValue;
 }
 
-void EveryIBus::handlePacket() {
-    uint8_t packet[4];
+void EveryIBus::assignAddress(uint8_t index, uint8_t address) {
+    _sensors[index].address = address;
+    _addressMap[address] = index;
+    _freeAddresses &= ~(1u << address);
     
-    // Read 4-byte packet
-    for (int i = 0; i < 4; i++) {
-        packet[i] = _serial->read();
+    if (_pendingAddress == address) {
+        _pendingAddress = 0;
     }
     
-    _packetCount++;
+    buildMeasurementFrame(index);
+}
+
+void EveryIBus::receive(uint8_t data) {
+    // Our own reply comes back through the TX resistor - skip it
+    if (_echoSkip) {
+        _echoSkip--;
+        return;
+    }
     
-    if (_debug) {
-        debugPrint("RX: ");
-        debugPrintHex(packet, 4);
+    // Hunt for a plausible length byte to start a frame
+    if (_rxLen == 0 && (data < IBUS_MIN_FRAME_LEN || data > IBUS_MAX_FRAME_LEN)) {
+        return;
     }
     
+    _rxBuf[_rxLen++] = data;
+    if (_rxLen < _rxBuf[0]) return;
+    
+    // Complete frame
+    _rxLen = 0;
+    if (_pendingAddress) {
+        resolvePendingAddress(_rxBuf);
+    }
+    if (_rxBuf[0] == IBUS_MIN_FRAME_LEN) {
+        handlePacket(_rxBuf);
+    } else {
+        handleReply(_rxBuf);
+    }
+}
+
+void EveryIBus::handlePacket(const uint8_t* packet) {
+    _packetCount++;
+    
+    IBUS_TRACE("RX: ");
+    IBUS_TRACE_HEX(packet, 4);
+    
     // Validate packet structure and checksum
+    // Only well-formed polls for addresses 1-15 get past validation
     if (validatePacket(packet)) {
         uint8_t command = packet[1] & 0xF0;
         uint8_t address = packet[1] & 0x0F;
         
-        // Handle addresses 1-4 for our sensors
-        if (address >= 1 && address <= 4) {
-            switch (command) {
-                case IBUS_CMD_DISCOVER:
-                    handleDiscoveryCommand(address);
-                    break;
-                    
-                case IBUS_CMD_TYPE:
-                    sendTypeResponse(address);
-                    break;
-                    
-                case IBUS_CMD_MEASUREMENT:
-                    sendMeasurementResponse(address);
-                    break;
-            }
+        switch (command) {
+            case IBUS_CMD_DISCOVER:
+                handleDiscoveryCommand(address);
+                break;
+                
+            case IBUS_CMD_TYPE:
+                sendTypeResponse(address);
+                break;
+                
+            case IBUS_CMD_MEASUREMENT:
+                sendMeasurementResponse(address);
+                break;
         }
     }
     
-    if (_debug) {
-        Serial.println();
+    IBUS_TRACE_END();
+}
+
+void EveryIBus::handleReply(const uint8_t* frame) {
+    // Another sensor answering TYPE or MEASUREMENT - its address is taken
+    if (!_dynamicAddressing) return;
+    
+    uint8_t length = frame[0];
+    uint16_t checksum = calculateChecksum(frame, length - 2);
+    if (frame[length - 2] != (checksum & 0xFF) || frame[length - 1] != (checksum >> 8)) {
+        return;
     }
     
-    // Clear buffer AFTER processing
-    clearSerialBuffer();
+    uint8_t address = frame[1] & 0x0F;
+    if (address == 0 || slotForAddress(address) != IBUS_NO_SLOT) return;
+    
+    _foreignAddresses |= (1u << address);
+    _freeAddresses &= ~(1u << address);
+    if (_pendingAddress == address) {
+        _pendingAddress = 0;
+    }
+    
+    IBUS_TRACE_VALUE("RX reply -> FOREIGN ADDR:", address);
+    IBUS_TRACE_END();
 }
 
 void EveryIBus::handleDiscoveryCommand(uint8_t address) {
+    if (_dynamicAddressing && slotForAddress(address) == IBUS_NO_SLOT &&
+        !(_foreignAddresses & (1u << address)) && waitingSlot() != IBUS_NO_SLOT) {
+        if (!(_freeAddresses & (1u << address))) {
+            // Unknown address: answered in update() if nobody else does
+            _pendingAddress = address;
+            _pendingSince = micros();
+            
+            IBUS_TRACE_VALUE(" -> PENDING ADDR:", address);
+            return;
+        }
+        
+        // Seen free in an earlier sweep - claim it right away
+        assignAddress(waitingSlot(), address);
+        IBUS_TRACE_VALUE(" -> CLAIMED ADDR:", address);
+    }
+    
     // Check if we have a sensor for this address
-    if (address <= MAX_SENSORS && _sensors[address - 1].hasValue) {
+    if (slotForAddress(address) != IBUS_NO_SLOT) {
         sendDiscoveryResponse(address);
         _anyDiscovered = true;
         
-        if (_debug) {
-            debugPrint(" -> DISCOVERY ADDR:");
-            Serial.print(address);
-            debugPrint(" [SENT]");
-        }
+        IBUS_TRACE_VALUE(" -> DISCOVERY ADDR:", address);
+        IBUS_TRACE(" [SENT]");
     } else {
-        if (_debug) {
-            debugPrint(" -> DISCOVERY ADDR:");
-            Serial.print(address);
-            debugPrint(" (no sensor)");
+        IBUS_TRACE_VALUE(" -> DISCOVERY ADDR:", address);
+        IBUS_TRACE(" (no sensor)");
+    }
+}
+
+void EveryIBus::resolvePendingAddress(const uint8_t* frame) {
+    // A discovery reply is an exact copy of the poll. A copy as the very
+    // next frame means another device has the address; any other frame
+    // means the receiver moved on without an answer.
+    uint8_t address = _pendingAddress;
+    _pendingAddress = 0;
+    
+    if (frame[0] == IBUS_MIN_FRAME_LEN && frame[1] == (IBUS_CMD_DISCOVER | address) && validatePacket(frame)) {
+        _foreignAddresses |= (1u << address);
+        
+        IBUS_TRACE_VALUE("RX copy -> FOREIGN ADDR:", address);
+        IBUS_TRACE_END();
+    } else {
+        _freeAddresses |= (1u << address);
+    }
+}
+
+void EveryIBus::claimPendingAddress() {
+    // The line stayed quiet for the claim window after the poll: answer
+    // it ourselves while the receiver is still waiting
+    uint8_t address = _pendingAddress;
+    uint8_t slot = waitingSlot();
+    _pendingAddress = 0;
+    if (slot == IBUS_NO_SLOT) {
+        _freeAddresses |= (1u << address);
+        return;
+    }
+    
+    assignAddress(slot, address);
+    sendDiscoveryResponse(address);
+    _anyDiscovered = true;
+    
+    IBUS_TRACE_VALUE("EveryIBus: CLAIMED ADDR:", address);
+    IBUS_TRACE_END();
+}
+
+uint8_t EveryIBus::waitingSlot() const {
+    // First sensor with a value and no address yet
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        if (_sensors[i].hasValue && _sensors[i].address == 0) {
+            return i;
         }
     }
+    return IBUS_NO_SLOT;
 }
 
 void EveryIBus::sendDiscoveryResponse(uint8_t address) {
@@ -201,13 +1005,18 @@ void EveryIBus::sendDiscoveryResponse(uint8_t address) {
 }
 
 void EveryIBus::sendTypeResponse(uint8_t address) {
-    if (address > MAX_SENSORS || !_sensors[address - 1].hasValue) return;
+    uint8_t index = slotForAddress(address);
+    if (index == IBUS_NO_SLOT) return;
     
     uint8_t response[6];
     response[0] = 0x06;  // Packet length
     response[1] = 0x90 | address;  // Command + address
-    response[2] = _sensors[address - 1].type;  // Sensor type
-    response[3] = 0x02;  // Always 0x02
+    response[2] = _sensors[index].type;  // Sensor type
+#if EVERYIBUS_WIDE_SENSORS
+    response[3] = _sensors[index].type >= IBUS_SENSOR_WIDE_FIRST ? 0x04 : 0x02;  // Value size
+#else
+    response[3] = 0x02;  // Value size
+#endif
     
     // Calculate checksum
     uint16_t checksum = calculateChecksum(response, 4);
@@ -217,47 +1026,62 @@ void EveryIBus::sendTypeResponse(uint8_t address) {
     sendPacket(response, 6);
     _responseCount++;
     
-    if (_debug) {
-        debugPrint(" -> TYPE ADDR:");
-        Serial.print(address);
-        debugPrint(" [SENT]");
-    }
+    IBUS_TRACE_VALUE(" -> TYPE ADDR:", address);
+    IBUS_TRACE(" [SENT]");
 }
 
 void EveryIBus::sendMeasurementResponse(uint8_t address) {
-    if (address > MAX_SENSORS || !_sensors[address - 1].hasValue) return;
+    uint8_t index = slotForAddress(address);
+    if (index == IBUS_NO_SLOT) return;
     
-    uint8_t response[6];
-    response[0] = 0x06;  // Packet length
-    response[1] = 0xA0 | address;  // Command + address
-    
-    uint16_t value = _sensors[address - 1].value;
-    response[2] = value & 0xFF;        // Value low byte
-    response[3] = (value >> 8) & 0xFF; // Value high byte
-    
-    // Calculate checksum
-    uint16_t checksum = calculateChecksum(response, 4);
-    response[4] = checksum & 0xFF;
-    response[5] = (checksum >> 8) & 0xFF;
+#if EVERYIBUS_STALENESS
+    Sensor& sensor = _sensors[index];
+    if (sensor.maxAge && (millis() - sensor.updatedAt) > sensor.maxAge) {
+        if (!sensor.stale) {
+            // Switch once; the next set rebuilds the live frame
+            sensor.stale = true;
+            _staleCount++;
+            buildMeasurementFrame(index);
+            
+            IBUS_TRACE_VALUE(" -> STALE ADDR:", address);
+        }
+        if (sensor.staleMode == IBUS_STALE_SILENT) return;
+    }
+#endif
     
-    sendPacket(response, 6);
+    // Frame was built when the value was set
+    uint8_t* frame = frameFor(index);
+    sendPacket(frame, frame[0]);
     _responseCount++;
     
-    if (_debug) {
-        debugPrint(" -> MEASUREMENT ADDR:");
-        Serial.print(address);
-        debugPrint(" [SENT]");
-    }
+    IBUS_TRACE_VALUE(" -> MEASUREMENT ADDR:", address);
+    IBUS_TRACE(" [SENT]");
 }
 
 // ... [Keep all the existing utility functions unchanged]
 
-bool EveryIBus::validatePacket(uint8_t* packet) {
+uint8_t EveryIBus::slotForAddress(uint8_t address) const {
+    // The only address -> slot lookup; anything out of range has no slot
+    return address <= IBUS_MAX_ADDRESS ? _addressMap[address] : IBUS_NO_SLOT;
+}
+
+bool EveryIBus::validatePacket(const uint8_t* packet) {
     // Check packet length
     if (packet[0] != 0x04) {
         return false;
     }
     
+    // Known command for a sensor address (0 is the receiver itself)
+    uint8_t command = packet[1] & 0xF0;
+    uint8_t address = packet[1] & 0x0F;
+    if (command != IBUS_CMD_DISCOVER && command != IBUS_CMD_TYPE &&
+        command != IBUS_CMD_MEASUREMENT) {
+        return false;
+    }
+    if (address == 0) {
+        return false;
+    }
+    
     // Verify checksum
     uint16_t expectedChecksum = 0xFFFF - (packet[0] + packet[1]);
     uint16_t receivedChecksum = (packet[3] << 8) | packet[2];
@@ -265,19 +1089,19 @@ bool EveryIBus::validatePacket(uint8_t* packet) {
     return (expectedChecksum == receivedChecksum);
 }
 
-void EveryIBus::sendPacket(uint8_t* data, uint8_t length) {
-    if (!_serial) return;
+void EveryIBus::sendPacket(const uint8_t* data, uint8_t length) {
+    if (!_port.isOpen()) return;
     
-    // Send immediately - no delays for timing-critical iBUS protocol
-    for (uint8_t i = 0; i < length; i++) {
-        _serial->write(data[i]);
+    // Send immediately - no delays for timing-critical iBUS protocol.
+    // No flush(): the TX interrupt drains the buffer while loop() runs on,
+    // and the parser skips the bytes when they come back on RX.
+    _port.write(data, length);
+    if (_skipEcho) {
+        _echoSkip += length;
     }
-    
-    // Ensure transmission completes
-    _serial->flush();
 }
 
-uint16_t EveryIBus::calculateChecksum(uint8_t* data, uint8_t length) {
+uint16_t EveryIBus::calculateChecksum(const uint8_t* data, uint8_t length) {
     uint16_t sum = 0;
     for (uint8_t i = 0; i < length; i++) {
         sum += data[i];
@@ -286,23 +1110,111 @@ uint16_t EveryIBus::calculateChecksum(uint8_t* data, uint8_t length) {
 }
 
 void EveryIBus::clearSerialBuffer() {
-    while (_serial && _serial->available()) {
-        _serial->read();
+    while (_port.isOpen() && _port.available()) {
+        _port.read();
     }
 }
 
-void EveryIBus::debugPrint(const char* message) {
+#if EVERYIBUS_DEBUG >= IBUS_DEBUG_TRACE
+void EveryIBus::debugPrintHex(const uint8_t* data, uint8_t length) {
     if (_debug) {
-        Serial.print(message);
+        for (uint8_t i = 0; i < length; i++) {
+            if (data[i] < 0x10) _debugOut->print(F("0"));
+            _debugOut->print(data[i], HEX);
+            if (i < length - 1) _debugOut->print(F(" "));
+        }
     }
 }
+#endif
 
-void EveryIBus::debugPrintHex(uint8_t* data, uint8_t length) {
-    if (_debug) {
-        for (uint8_t i = 0; i < length; i++) {
-            if (data[i] < 0x10) Serial.print(F("0"));
-            Serial.print(data[i], HEX);
-            if (i < length - 1) Serial.print(F(" "));
-        }
+// ---------------------------------------------------------------------------
+// EveryIBusGroup
+// ---------------------------------------------------------------------------
+
+EveryIBusGroup::EveryIBusGroup() {
+    _busCount = 0;
+    
+    for (int i = 0; i < MAX_BUSES; i++) {
+        _buses[i] = nullptr;
+    }
+}
+
+bool EveryIBusGroup::addBus(EveryIBus& bus) {
+    if (_busCount >= MAX_BUSES) return false;
+    
+    _buses[_busCount++] = &bus;
+    return true;
+}
+
+void EveryIBusGroup::update() {
+    // One pass over all buses: each reads at most its byte budget, so the
+    // cost of a call is bounded by the number of buses
+    for (uint8_t i = 0; i < _busCount; i++) {
+        _buses[i]->update();
+    }
+}
+
+#if EVERYIBUS_BATCH
+void EveryIBusGroup::beginBatch() {
+    for (uint8_t i = 0; i < _busCount; i++) {
+        _buses[i]->beginBatch();
     }
-}
\ No newline at end of file
+}
+
+void EveryIBusGroup::commitBatch() {
+    for (uint8_t i = 0; i < _busCount; i++) {
+        _buses[i]->commitBatch();
+    }
+}
+#endif
+
+void EveryIBusGroup::setInternalVoltage(float voltage) {
+    publish(IBUS_SENSOR_INTERNAL_VOLTAGE, EveryIBus::voltageToRaw(voltage));
+}
+
+void EveryIBusGroup::setExternalVoltage(float voltage) {
+    publish(IBUS_SENSOR_EXTERNAL_VOLTAGE, EveryIBus::voltageToRaw(voltage));
+}
+
+void EveryIBusGroup::setTemperature(float tempC) {
+    publish(IBUS_SENSOR_TEMPERATURE, EveryIBus::temperatureToRaw(tempC));
+}
+
+void EveryIBusGroup::setRPM(uint16_t rpm) {
+    publish(IBUS_SENSOR_RPM, rpm);
+}
+
+void EveryIBusGroup::setCurrent(float amps) {
+    publish(IBUS_SENSOR_CURRENT, EveryIBus::currentToRaw(amps));
+}
+
+void EveryIBusGroup::setCellVoltage(float voltage) {
+    publish(IBUS_SENSOR_CELL_VOLTAGE, EveryIBus::voltageToRaw(voltage));
+}
+
+void EveryIBusGroup::setHeading(float degrees) {
+    publish(IBUS_SENSOR_HEADING, (uint16_t)degrees);
+}
+
+void EveryIBusGroup::setClimbRate(float metersPerSecond) {
+    publish(IBUS_SENSOR_CLIMB_RATE, (uint16_t)(int16_t)(metersPerSecond * 100.0f));
+}
+
+#if EVERYIBUS_WIDE_SENSORS
+void EveryIBusGroup::setAltitude(float meters) {
+    setWideValue(IBUS_SENSOR_ALTITUDE, (int32_t)(meters * 100.0f));
+}
+
+void EveryIBusGroup::setWideValue(uint8_t sensorType, int32_t value) {
+    for (uint8_t i = 0; i < _busCount; i++) {
+        _buses[i]->setWideValue(sensorType, value);
+    }
+}
+#endif
+
+void EveryIBusGroup::publish(uint8_t sensorType, uint16_t rawValue) {
+    // Converted once by the caller, stored (and framed) once per bus
+    for (uint8_t i = 0; i < _busCount; i++) {
+        _buses[i]->setSensorValue(sensorType, rawValue);
+    }
+}
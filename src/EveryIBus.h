@@ -26,80 +26,525 @@
 #define EVERYIBUS_H
 
 #include <Arduino.h>
+#include "EveryIBusConfig.h"
+#include "EveryIBusTransport.h"
+
+#define EVERYIBUS_VERSION "1.0.0"
 
 // Internal sensor definitions (user doesn't need these)
 #define IBUS_SENSOR_INTERNAL_VOLTAGE  0x00
 #define IBUS_SENSOR_TEMPERATURE       0x01  
 #define IBUS_SENSOR_RPM              0x02
 #define IBUS_SENSOR_EXTERNAL_VOLTAGE  0x03
+#define IBUS_SENSOR_CURRENT           0x05
+#define IBUS_SENSOR_FUEL              0x06
+
+// Further types shown by newer FlySky transmitter firmware
+#define IBUS_SENSOR_CELL_VOLTAGE      0x04  // 0.01V
+#define IBUS_SENSOR_HEADING           0x08  // Degrees, 0 = north
+#define IBUS_SENSOR_CLIMB_RATE        0x09  // 0.01m/s, signed
+
+// Types from 0x80 up carry a signed 32-bit value (EVERYIBUS_WIDE_SENSORS)
+#define IBUS_SENSOR_GPS_LAT           0x80  // Degrees * 1e7
+#define IBUS_SENSOR_GPS_LON           0x81  // Degrees * 1e7
+#define IBUS_SENSOR_GPS_ALT           0x82  // 0.01m
+#define IBUS_SENSOR_ALTITUDE          0x83  // 0.01m
+#define IBUS_SENSOR_ALTITUDE_MAX      0x84  // 0.01m
+#define IBUS_SENSOR_WIDE_FIRST        0x80
 
 // iBUS protocol commands (internal use)
 #define IBUS_CMD_DISCOVER            0x80
 #define IBUS_CMD_TYPE                0x90
 #define IBUS_CMD_MEASUREMENT         0xA0
 
-// Maximum number of sensors we support
-#define MAX_SENSORS 4
+// Length of a MEASUREMENT response frame (2- and 4-byte values)
+#define IBUS_MEASUREMENT_FRAME_LEN   6
+#define IBUS_WIDE_FRAME_LEN          8
+
+#if EVERYIBUS_WIDE_SENSORS
+#define IBUS_FRAME_BUFFER_LEN        IBUS_WIDE_FRAME_LEN
+#else
+#define IBUS_FRAME_BUFFER_LEN        IBUS_MEASUREMENT_FRAME_LEN
+#endif
+
+// Frames on the wire start with their length: 4-byte polls from the
+// receiver, longer replies from sensors
+#define IBUS_MIN_FRAME_LEN           4
+#define IBUS_MAX_FRAME_LEN           32
+
+// A partial frame is dropped once the line has been quiet this long
+#define IBUS_FRAME_GAP_US            1000
+
+// Bus addresses 1-15 are available to sensors (0 is the receiver itself)
+#define IBUS_MAX_ADDRESS             15
+#define IBUS_NO_SLOT                 0xFF
+
+// Dynamic addressing: how long the line must stay quiet after a
+// DISCOVER of an unknown address before we answer it ourselves. Another
+// device answering later than this collides with our reply.
+#ifndef IBUS_DISCOVERY_CLAIM_US
+#define IBUS_DISCOVERY_CLAIM_US      500
+#endif
+
+// What a sensor does when its value is older than its maximum age
+#define IBUS_STALE_SILENT            0   // Stop answering MEASUREMENT polls
+#define IBUS_STALE_FAILSAFE          1   // Report the configured failsafe value
+
+// Alarm thresholds that never trigger
+#define IBUS_ALARM_NO_LOW            0x0000
+#define IBUS_ALARM_NO_HIGH           0xFFFF
+
+// What a removed sensor does towards the receiver
+#define IBUS_REMOVE_SILENT           0   // Free the slot, stop answering
+#define IBUS_REMOVE_FAILSAFE         1   // Keep type and address, report a fixed value
+
+// Gaps between current samples longer than this are integrated as this
+// long, which keeps the fixed-point accumulators from overflowing
+#define IBUS_MAX_INTEGRATION_MS      10000
+
+// Energy is integrated in steps of at most this long: 65535 * 65535 / 1000
+// (0.1W) times 1000ms stays below 2^32 with the remainder added
+#define IBUS_INTEGRATION_STEP_MS     1000
 
 struct Sensor {
     uint8_t type;
     uint16_t value;
+#if EVERYIBUS_WIDE_SENSORS
+    uint16_t valueHigh;   // Upper half of a 4-byte value
+#endif
     bool hasValue;
+    bool parked;      // Removed with IBUS_REMOVE_FAILSAFE, frame frozen
+    uint8_t address;  // Bus address, 0 = not assigned yet
+    uint8_t generation;  // Bumped on removal, so old handles stop matching
+    
+    // Optional filter stages (see EveryIBusConfig.h)
+#if EVERYIBUS_FILTER_MEDIAN
+    bool median;
+    uint8_t medianPos;
+    uint16_t medianWindow[EVERYIBUS_MEDIAN_SIZE];
+#endif
+#if EVERYIBUS_FILTER_EMA
+    uint8_t emaShift;    // 0 = off
+    uint32_t emaAccum;   // Filtered value << emaShift
+#endif
+#if EVERYIBUS_FILTER_SLEW
+    uint16_t slewLimit;  // Max change per sample in raw units, 0 = off
+#endif
+#if EVERYIBUS_ALARMS
+    uint16_t alarmLow;       // Raw units, alarm below this
+    uint16_t alarmHigh;      // Raw units, alarm above this
+    uint16_t alarmHysteresis;
+    bool alarmActive;
+#endif
+#if EVERYIBUS_STALENESS
+    uint32_t updatedAt;      // millis() of the last set
+    uint16_t maxAge;         // ms, 0 = never stale
+    uint16_t failsafeValue;
+    uint8_t staleMode;
+    bool stale;
+#endif
+#if EVERYIBUS_BATCH
+    uint8_t frame[2][IBUS_FRAME_BUFFER_LEN];  // Live one picked by the front mask
+#else
+    uint8_t frame[IBUS_FRAME_BUFFER_LEN];  // Precomputed MEASUREMENT response
+#endif
 };
 
+class EveryIBusGroup;
+class EveryIBusSensor;
+class EveryIBusSPort;
+class EveryIBusCRSF;
+
+// Told about each slot whose live value changed or that was removed, so
+// another protocol backend can re-encode it (see EveryIBusSPort)
+typedef void (*IBusSlotHook)(void* context, uint8_t slot);
+
+#if EVERYIBUS_ALARMS
+// Called when a sensor's alarm is raised (active = true) or cleared;
+// slot tells several sensors of one type apart
+typedef void (*IBusAlarmCallback)(uint8_t slot, uint8_t sensorType, bool active);
+#endif
+
 class EveryIBus {
+    friend class EveryIBusGroup;
+    friend class EveryIBusSensor;
+    friend class EveryIBusSPort;
+    friend class EveryIBusCRSF;
+    friend class EveryIBusBench;   // extras/linux/ibus-bench.cpp
+    
 public:
+    typedef EVERYIBUS_TRANSPORT Transport;
+    
     // Constructor
     EveryIBus();
     
     // Super simple initialization - uses Serial1 by default
-    void begin(HardwareSerial& serial = Serial1);
+    void begin(Transport::Port& port = Transport::defaultPort());
     
-    // Must be called regularly in loop() - handles protocol
+    // Must be called regularly in loop() - handles protocol. Reads at most
+    // the byte budget per call and resumes a partial frame next time.
     void update();
+    void setUpdateBudget(uint8_t bytes) { _byteBudget = bytes ? bytes : 1; }
+    
+    // Byte-in side of the protocol core. update() passes every received
+    // byte through here; replies go out through the transport. Can also
+    // be fed directly (same context as update(), not from an interrupt).
+    void receive(uint8_t data);
+    
+    // Our replies come back on RX through the TX resistor and are skipped.
+    // Turn this off for wiring without that loopback (e.g. a pty).
+    void setEchoSkip(bool enable) { _skipEcho = enable; }
+    
+    // Longest single update() call so far, in microseconds
+    uint32_t getMaxUpdateMicros() const { return _maxUpdateMicros; }
+    void resetMaxUpdateMicros() { _maxUpdateMicros = 0; }
     
     // Simple sensor value setters - use real-world units
     void setInternalVoltage(float voltage);    // Volts (e.g., 5.08)
     void setExternalVoltage(float voltage);    // Volts (e.g., 12.41) 
     void setTemperature(float tempC);          // Celsius (e.g., 21.12)
     void setRPM(uint16_t rpm);                 // RPM (e.g., 4294)
+    void setCurrent(float amps);               // Amps (e.g., 23.5)
+    void setCellVoltage(float voltage);        // Volts per cell (e.g., 3.92)
+    void setHeading(float degrees);            // 0-360, 0 = north
+    void setClimbRate(float metersPerSecond);  // Negative when sinking
+#if EVERYIBUS_WIDE_SENSORS
+    void setAltitude(float meters);            // Relative altitude (e.g., 120.5)
+#endif
+    
+    // Raw iBUS units (e.g. 0.01V) - used by the built-in sample sources
+    void setSensorValue(uint8_t sensorType, uint16_t rawValue);
+    
+    // Registration: addSensor() reserves a new slot (also for a type that
+    // is already in use) and returns a handle whose setters store straight
+    // into it. The handle is invalid if all slots are taken. The indexed
+    // setters below do the same by slot number (handle.getSlot()).
+    // The type-keyed calls above always use the first slot of a type.
+    EveryIBusSensor addSensor(uint8_t sensorType);
+    void setSlotValue(uint8_t slot, uint16_t rawValue);
+    
+#if EVERYIBUS_WIDE_SENSORS
+    // 4-byte types (IBUS_SENSOR_GPS_LAT...); filters and alarms don't apply
+    void setWideValue(uint8_t sensorType, int32_t value);
+    void setSlotWideValue(uint8_t slot, int32_t value);
+#endif
+    void setInternalVoltage(uint8_t slot, float voltage);
+    void setExternalVoltage(uint8_t slot, float voltage);
+    void setTemperature(uint8_t slot, float tempC);
+    void setRPM(uint8_t slot, uint16_t rpm);
+    void setCurrent(uint8_t slot, float amps);
+    
+    // Take a sensor off the bus at runtime, e.g. when a payload is swapped.
+    // IBUS_REMOVE_FAILSAFE keeps answering with failsafeValue on the same
+    // address; the next addSensor() of that type takes the slot over, so
+    // the receiver never loses the sensor. Safe while update() runs from
+    // an interrupt.
+    bool removeSensor(uint8_t slot, uint8_t mode = IBUS_REMOVE_SILENT, uint16_t failsafeValue = 0);
     
-    // Optional: Enable/disable debug output to Serial
-    void setDebug(bool enable) { _debug = enable; }
+#if EVERYIBUS_BATCH
+    // Optional: Publish related values together (e.g. voltage, current and
+    // consumption). Sets between the two calls are staged; commitBatch()
+    // makes all of them live at once, so no poll sees a mixed set.
+    void beginBatch() { _batching = true; }
+    void commitBatch();
+#endif
+    
+    // Optional: Per-sensor filtering of noisy values (raw iBUS units).
+    // Like the setters, the type-keyed calls configure the first slot of
+    // a type; the setSlot...() calls (or the handle) reach any slot.
+#if EVERYIBUS_FILTER_MEDIAN
+    bool setMedianFilter(uint8_t sensorType, bool enable);       // Median of last N samples
+    bool setSlotMedianFilter(uint8_t slot, bool enable);
+#endif
+#if EVERYIBUS_FILTER_EMA
+    bool setEMAFilter(uint8_t sensorType, uint8_t shift);        // Weight 1/2^shift, 0 = off
+    bool setSlotEMAFilter(uint8_t slot, uint8_t shift);
+#endif
+#if EVERYIBUS_FILTER_SLEW
+    bool setSlewLimit(uint8_t sensorType, uint16_t maxStep);     // Max change per sample, 0 = off
+    bool setSlotSlewLimit(uint8_t slot, uint16_t maxStep);
+#endif
+    
+#if EVERYIBUS_STALENESS
+    // Optional: Treat a value as stale if it isn't refreshed within maxAgeMs
+    bool setMaxAge(uint8_t sensorType, uint16_t maxAgeMs,
+                   uint8_t mode = IBUS_STALE_SILENT, uint16_t failsafeValue = 0);
+    bool setSlotMaxAge(uint8_t slot, uint16_t maxAgeMs,
+                       uint8_t mode = IBUS_STALE_SILENT, uint16_t failsafeValue = 0);
+    uint32_t getStaleCount() const { return _staleCount; }
+#endif
+    
+#if EVERYIBUS_ALARMS
+    // Optional: Raise an alarm when a value leaves [low, high] (raw units).
+    // It clears once the value is back inside by at least hysteresis.
+    bool setAlarm(uint8_t sensorType, uint16_t low, uint16_t high, uint16_t hysteresis = 0);
+    bool setSlotAlarm(uint8_t slot, uint16_t low, uint16_t high, uint16_t hysteresis = 0);
+    void onAlarm(IBusAlarmCallback callback) { _alarmCallback = callback; }
+    void setAlarmPin(uint8_t pin, bool activeHigh = true);  // e.g. a buzzer
+    uint16_t getAlarmStatus() const { return _alarmStatus; } // Bit per sensor slot
+    bool isAlarmActive(uint8_t sensorType);
+    bool isSlotAlarmActive(uint8_t slot) const { return slot < MAX_SENSORS && (_alarmStatus & (1u << slot)); }
+#endif
+    
+    // Computed sensors - derived from external voltage and current samples
+    void enableConsumption(bool enable) { _reportConsumption = enable; }  // Publish mAh as Fuel
+    void resetConsumption();
+    uint32_t getConsumedMah() const { return _consumedMah; }     // mAh since start/reset
+    uint32_t getEnergy() const { return _energyMilliWh; }        // mWh since start/reset
+    uint32_t getPower() const;                                   // 0.01W units
+    
+#if EVERYIBUS_DEBUG
+    // Optional: Enable/disable debug output (to Serial unless another port is given)
+    void setDebug(bool enable, Print& output = Serial) { _debug = enable; _debugOut = &output; }
+#endif
+    
+    // Optional: Claim free bus addresses instead of slot N = address N.
+    // Call before begin() so discovery starts from a clean address map.
+    void setDynamicAddressing(bool enable);
     
     // Optional: Get statistics
     uint32_t getPacketCount() const { return _packetCount; }
     uint32_t getResponseCount() const { return _responseCount; }
     bool isDiscovered() const { return _anyDiscovered; }
     
+    // Protocol helpers (pure functions, e.g. for benchmarks)
+    static bool validatePacket(const uint8_t* packet);
+    static uint16_t calculateChecksum(const uint8_t* data, uint8_t length);
+    
 private:
-    HardwareSerial* _serial;
+    Transport _port;
     Sensor _sensors[MAX_SENSORS];
     uint8_t _currentSensorIndex;
     bool _anyDiscovered;
     uint32_t _packetCount;
     uint32_t _responseCount;
+    
+    // Resumable receive state
+    uint8_t _rxBuf[IBUS_MAX_FRAME_LEN];
+    uint8_t _rxLen;
+    uint8_t _echoSkip;           // Bytes of our own reply still to come back
+    bool _skipEcho;
+    uint8_t _byteBudget;
+    uint32_t _lastRxMicros;
+    uint32_t _maxUpdateMicros;
+#if EVERYIBUS_STALENESS
+    uint32_t _staleCount;
+#endif
+#if EVERYIBUS_ALARMS
+    uint16_t _alarmStatus;
+    IBusAlarmCallback _alarmCallback;
+    uint8_t _alarmPin;
+    bool _alarmPinActiveHigh;
+#endif
+#if EVERYIBUS_DEBUG
     bool _debug;
+    Print* _debugOut;
+#endif
+    
+    // Address allocation
+    bool _dynamicAddressing;
+    uint8_t _addressMap[IBUS_MAX_ADDRESS + 1];  // Address -> sensor slot
+    uint16_t _foreignAddresses;                 // Answered by other devices
+    uint16_t _freeAddresses;                    // Polled with nobody answering
+    uint8_t _pendingAddress;                    // DISCOVER seen, nobody answered yet
+    uint32_t _pendingSince;
+    
+    // Second protocol backend reading the same slots
+    IBusSlotHook _slotHook;
+    void* _slotHookContext;
+    
+    // First slot of each type that drives the computed sensors
+    uint8_t _voltageSlot;
+    uint8_t _currentSlot;
+    
+#if EVERYIBUS_BATCH
+    bool _batching;
+    uint16_t _batchMask;   // Slots set since beginBatch()
+    uint16_t _frontMask;   // Frame buffer each slot answers from
+#endif
+    
+    // Computed sensors (fixed point: 0.01V, 0.01A, remainders in x*ms)
+    bool _reportConsumption;
+    bool _hasCurrentSample;
+    uint16_t _batteryVoltage;
+    uint16_t _current;
+    uint32_t _lastCurrentMillis;
+    uint32_t _chargeRemainder;   // 0.01A*ms not yet a whole mAh
+    uint32_t _energyRemainder;   // 0.1W*ms not yet a whole mWh
+    uint32_t _consumedMah;
+    uint32_t _energyMilliWh;
     
     // Protocol handlers
-    void handlePacket();
+    void handlePacket(const uint8_t* packet);
+    void handleReply(const uint8_t* frame);
     void handleDiscoveryCommand(uint8_t address);
+    void resolvePendingAddress(const uint8_t* frame);
+    void claimPendingAddress();
+    uint8_t waitingSlot() const;
+    void assignAddress(uint8_t index, uint8_t address);
     void sendDiscoveryResponse(uint8_t address);
     void sendTypeResponse(uint8_t address);
     void sendMeasurementResponse(uint8_t address);
     
     // Utility functions
-    bool validatePacket(uint8_t* packet);
-    void sendPacket(uint8_t* data, uint8_t length);
-    uint16_t calculateChecksum(uint8_t* data, uint8_t length);
+    uint8_t slotForAddress(uint8_t address) const;
+    void sendPacket(const uint8_t* data, uint8_t length);
     void clearSerialBuffer();
-    void debugPrint(const char* message);
-    void debugPrintHex(uint8_t* data, uint8_t length);
+#if EVERYIBUS_DEBUG >= IBUS_DEBUG_TRACE
+    void debugPrintHex(const uint8_t* data, uint8_t length);
+#endif
     
     // Helper functions
-    void setSensorValue(uint8_t sensorType, uint16_t rawValue);
+    void buildMeasurementFrame(uint8_t index, bool back = false);
+    uint8_t* frameFor(uint8_t index, bool back = false);
+    void publishSlot(uint8_t index);
+    void notifySlot(uint8_t index) { if (_slotHook) _slotHook(_slotHookContext, index); }
     int8_t findSensorIndex(uint8_t sensorType);
-    uint8_t getNextAvailableAddress();
+    bool isSlotInUse(uint8_t slot) const {
+        return slot < MAX_SENSORS && _sensors[slot].type != 0xFF && !_sensors[slot].parked;
+    }
+    int8_t allocateSensor(uint8_t sensorType);
+    void storeValue(uint8_t index, uint16_t rawValue);
+#if EVERYIBUS_WIDE_SENSORS
+    void storeWideValue(uint8_t index, int32_t value);
+#endif
+    void commitValue(uint8_t index);
+    void feedComputedSensors(uint8_t sensorType, uint16_t rawValue);
+    void primeFilters(uint8_t index, uint16_t rawValue);
+    uint16_t filterValue(uint8_t index, uint16_t rawValue);
+    void evaluateAlarm(uint8_t index);
+    void setAlarmState(uint8_t index, bool active);
+    void updateAlarmPin();
+    void integrateCurrent(uint16_t current);
+    
+    // Unit conversion to iBUS raw format
+    static uint16_t voltageToRaw(float voltage);
+    static uint16_t temperatureToRaw(float tempC);
+    static uint16_t currentToRaw(float amps);
+};
+
+/*
+  EveryIBusSensor - handle to one sensor slot, returned by addSensor()
+  
+  Four bytes of state; every setter is a direct store into the slot
+  (filters, alarms and frame rebuild included), so the cost per sample
+  doesn't grow with the number of sensors. The handle remembers the
+  slot's generation: once the sensor is removed it does nothing, even
+  after addSensor() hands the slot to another sensor (until the slot
+  has been removed 256 more times).
+  
+  EveryIBusSensor motorTemp = ibus.addSensor(IBUS_SENSOR_TEMPERATURE);
+  motorTemp.setTemperature(61.5);
+*/
+class EveryIBusSensor {
+public:
+    EveryIBusSensor() : _bus(nullptr), _slot(IBUS_NO_SLOT), _generation(0) {}
+    EveryIBusSensor(EveryIBus* bus, uint8_t slot)
+        : _bus(bus), _slot(slot), _generation(bus->_sensors[slot].generation) {}
+    
+    // False for an empty handle and once the sensor was removed
+    bool isValid() const { return _bus && _bus->_sensors[_slot].generation == _generation; }
+    uint8_t getSlot() const { return _slot; }
+    
+    // Raw iBUS units - ignored once the sensor was removed
+    void set(uint16_t rawValue) { if (isValid()) _bus->setSlotValue(_slot, rawValue); }
+    
+    // Real-world units
+    void setVoltage(float voltage) { set(EveryIBus::voltageToRaw(voltage)); }
+    void setTemperature(float tempC) { set(EveryIBus::temperatureToRaw(tempC)); }
+    void setCurrent(float amps) { set(EveryIBus::currentToRaw(amps)); }
+    void setRPM(uint16_t rpm) { set(rpm); }
+#if EVERYIBUS_WIDE_SENSORS
+    void setWide(int32_t value) { if (isValid()) _bus->setSlotWideValue(_slot, value); }
+#endif
+    
+    // Per-slot settings, as the type-keyed calls on EveryIBus
+#if EVERYIBUS_FILTER_MEDIAN
+    bool setMedianFilter(bool enable) { return isValid() && _bus->setSlotMedianFilter(_slot, enable); }
+#endif
+#if EVERYIBUS_FILTER_EMA
+    bool setEMAFilter(uint8_t shift) { return isValid() && _bus->setSlotEMAFilter(_slot, shift); }
+#endif
+#if EVERYIBUS_FILTER_SLEW
+    bool setSlewLimit(uint16_t maxStep) { return isValid() && _bus->setSlotSlewLimit(_slot, maxStep); }
+#endif
+#if EVERYIBUS_STALENESS
+    bool setMaxAge(uint16_t maxAgeMs, uint8_t mode = IBUS_STALE_SILENT, uint16_t failsafeValue = 0) {
+        return isValid() && _bus->setSlotMaxAge(_slot, maxAgeMs, mode, failsafeValue);
+    }
+#endif
+#if EVERYIBUS_ALARMS
+    bool setAlarm(uint16_t low, uint16_t high, uint16_t hysteresis = 0) {
+        return isValid() && _bus->setSlotAlarm(_slot, low, high, hysteresis);
+    }
+    bool isAlarmActive() const { return isValid() && _bus->isSlotAlarmActive(_slot); }
+#endif
+    
+    bool remove(uint8_t mode = IBUS_REMOVE_SILENT, uint16_t failsafeValue = 0) {
+        return isValid() && _bus->removeSensor(_slot, mode, failsafeValue);
+    }
+    
+private:
+    EveryIBus* _bus;
+    uint8_t _slot;
+    uint8_t _generation;   // Slot generation at addSensor()
+};
+
+/*
+  EveryIBusGroup - services several independent iBUS sensor buses
+  
+  Each bus is a normal EveryIBus instance on its own USART with its own
+  statistics. Values set on the group are converted once and published
+  to every bus; each bus keeps its own precomputed response frames.
+  
+  EveryIBus bus1, bus2;
+  EveryIBusGroup group;
+  bus1.begin(Serial1);
+  bus2.begin(Serial2);
+  group.addBus(bus1);
+  group.addBus(bus2);
+  group.setExternalVoltage(12.41);  // Reported on both buses
+*/
+class EveryIBusGroup {
+public:
+    EveryIBusGroup();
+    
+    // Register a bus that has already been started with begin()
+    bool addBus(EveryIBus& bus);
+    
+    // Services every bus once - each reads at most its byte budget
+    void update();
+    
+    // Shared sensor setters - published to all buses
+    void setInternalVoltage(float voltage);
+    void setExternalVoltage(float voltage);
+    void setTemperature(float tempC);
+    void setRPM(uint16_t rpm);
+    void setCurrent(float amps);
+    void setCellVoltage(float voltage);
+    void setHeading(float degrees);
+    void setClimbRate(float metersPerSecond);
+    void setSensorValue(uint8_t sensorType, uint16_t rawValue) { publish(sensorType, rawValue); }
+#if EVERYIBUS_WIDE_SENSORS
+    void setAltitude(float meters);
+    void setWideValue(uint8_t sensorType, int32_t value);
+#endif
+    
+#if EVERYIBUS_BATCH
+    // Batch on every bus at once
+    void beginBatch();
+    void commitBatch();
+#endif
+    
+    // Access to individual buses (e.g. for per-bus statistics)
+    uint8_t getBusCount() const { return _busCount; }
+    EveryIBus& getBus(uint8_t index) { return *_buses[index]; }
+    
+private:
+    EveryIBus* _buses[MAX_BUSES];
+    uint8_t _busCount;
+    
+    void publish(uint8_t sensorType, uint16_t rawValue);
 };
 
 #endif // EVERYIBUS_H
\ No newline at end of file
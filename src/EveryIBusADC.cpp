@@ -0,0 +1,281 @@
+/*
+  EveryIBusADC.cpp - Background voltage sampling for EveryIBus
+
+  ADC0 scan with hardware accumulation, harvested by polling or by the
+  RESRDY interrupt (EVERYIBUS_ADC_USE_ISR).
+*/
+
+#include "EveryIBusADC.h"
+
+#if defined(ADC0) && defined(VREF)
+
+// DACREF with AC0REFSEL = 1.1V and DACREF = 255: 1.1V * 255/256 in 0.1mV
+#define DACREF_LEVEL        10957
+
+// Temperature sensor needs >= 32us sample time (32 ADC clocks at 1MHz)
+#define TEMPSENSE_SAMPLEN   32
+
+#if EVERYIBUS_ADC_USE_ISR
+static EveryIBusADC* isrInstance = nullptr;
+
+ISR(ADC0_RESRDY_vect) {
+    if (isrInstance) {
+        isrInstance->handleInterrupt();
+    } else {
+        ADC0.INTFLAGS = ADC_RESRDY_bm;
+    }
+}
+#endif
+
+EveryIBusADC::EveryIBusADC() {
+    _channelCount = 0;
+    _current = 0;
+    _sampleBits = 0;
+    _eventTriggered = false;
+    _needsDacref = false;
+#if EVERYIBUS_ADC_USE_ISR
+    _fresh = 0;
+#endif
+
+    for (int i = 0; i < EVERYIBUS_ADC_MAX_CHANNELS; i++) {
+        _channels[i].value = 0;
+        _lastAccum[i] = 0;
+    }
+}
+
+bool EveryIBusADC::addChannel(uint8_t pin, uint8_t sensorType, uint16_t fullScale, uint8_t reference) {
+    if (_channelCount >= EVERYIBUS_ADC_MAX_CHANNELS) return false;
+
+    uint8_t ain = digitalPinToAnalogInput(pin);
+    if (ain == NOT_A_PIN) return false;
+
+    ADCChannel& channel = _channels[_channelCount++];
+    channel.muxpos = ain;
+    channel.reference = reference;
+    channel.sensorType = sensorType;
+    channel.fullScale = fullScale;
+    channel.value = 0;
+    return true;
+}
+
+bool EveryIBusADC::addSupplyVoltage(uint8_t sensorType) {
+    if (_channelCount >= EVERYIBUS_ADC_MAX_CHANNELS) return false;
+
+    // Known internal level measured against VDD: VDD = level * full code / result
+    ADCChannel& channel = _channels[_channelCount++];
+    channel.muxpos = ADC_MUXPOS_DACREF_gc;
+    channel.reference = IBUS_ADC_REF_VDD;
+    channel.sensorType = sensorType;
+    channel.fullScale = DACREF_LEVEL;
+    channel.value = 0;
+    _needsDacref = true;
+    return true;
+}
+
+bool EveryIBusADC::addTemperature(uint8_t sensorType) {
+    if (_channelCount >= EVERYIBUS_ADC_MAX_CHANNELS) return false;
+
+    ADCChannel& channel = _channels[_channelCount++];
+    channel.muxpos = ADC_MUXPOS_TEMPSENSE_gc;
+    channel.reference = IBUS_ADC_REF_1V1;  // Required by the sensor calibration
+    channel.sensorType = sensorType;
+    channel.fullScale = 0;
+    channel.value = 0;
+    return true;
+}
+
+void EveryIBusADC::begin(uint8_t sampleBits) {
+    _eventTriggered = false;
+    start(sampleBits);
+}
+
+void EveryIBusADC::beginEvent(uint8_t eventChannel, uint8_t sampleBits) {
+    EVSYS.USERADC0 = eventChannel + 1;  // EVSYS_CHANNEL_CHANNELn_gc
+    _eventTriggered = true;
+    start(sampleBits);
+}
+
+void EveryIBusADC::update(EveryIBus& ibus) {
+#if EVERYIBUS_ADC_USE_ISR
+    noInterrupts();
+    uint8_t fresh = _fresh;
+    _fresh = 0;
+    interrupts();
+
+    for (uint8_t i = 0; fresh; i++, fresh >>= 1) {
+        if (fresh & 1) {
+            noInterrupts();
+            uint16_t value = _channels[i].value;
+            interrupts();
+            ibus.setSensorValue(_channels[i].sensorType, value);
+        }
+    }
+#else
+    if (!(ADC0.INTFLAGS & ADC_RESRDY_bm)) return;
+
+    uint8_t index = _current;
+    harvest(ADC0.RES);  // Reading RES clears RESRDY
+    ibus.setSensorValue(_channels[index].sensorType, _channels[index].value);
+#endif
+}
+
+void EveryIBusADC::calibrate(uint8_t channel, uint16_t actualVoltage) {
+    if (channel >= _channelCount) return;
+
+    noInterrupts();
+    uint16_t accum = _lastAccum[channel];
+    interrupts();
+    if (accum == 0) return;
+
+    if (_channels[channel].muxpos == ADC_MUXPOS_TEMPSENSE_gc) {
+        return; // Factory calibrated in SIGROW
+    }
+
+    if (_channels[channel].muxpos == ADC_MUXPOS_DACREF_gc) {
+        // DACREF level (0.1mV) that makes the last reading equal actualVoltage
+        uint32_t level = ((uint32_t)actualVoltage * accum * 100UL) / (1023UL << _sampleBits);
+        _channels[channel].fullScale = level > 0xFFFF ? 0xFFFF : (uint16_t)level;
+        computeScale(channel);
+        return;
+    }
+
+    // Full scale that makes the last accumulated reading equal actualVoltage
+    uint32_t fullScale = ((uint32_t)actualVoltage * (1023UL << _sampleBits)) / accum;
+    _channels[channel].fullScale = fullScale > 0xFFFF ? 0xFFFF : (uint16_t)fullScale;
+    computeScale(channel);
+}
+
+#if EVERYIBUS_ADC_USE_ISR
+void EveryIBusADC::handleInterrupt() {
+    uint8_t index = _current;
+    harvest(ADC0.RES);
+    _fresh |= (1 << index);
+}
+#endif
+
+void EveryIBusADC::start(uint8_t sampleBits) {
+    if (_channelCount == 0) return;
+
+    _sampleBits = sampleBits > 6 ? 6 : sampleBits;
+    _current = 0;
+
+    for (uint8_t i = 0; i < _channelCount; i++) {
+        computeScale(i);
+    }
+
+#if EVERYIBUS_ADC_USE_ISR
+    isrInstance = this;
+#endif
+
+    if (_needsDacref) {
+        VREF.CTRLA = (VREF.CTRLA & ~VREF_AC0REFSEL_gm) | VREF_AC0REFSEL_1V1_gc;
+        VREF.CTRLB |= VREF_AC0REFEN_bm;
+        AC0.DACREF = 0xFF;
+    }
+
+    ADC0.CTRLA = 0;
+    ADC0.CTRLB = _sampleBits;                // SAMPNUM: accumulate 2^n results
+    ADC0.CTRLD = ADC_INITDLY_DLY32_gc;       // Settle after reference changes
+    ADC0.EVCTRL = _eventTriggered ? ADC_STARTEI_bm : 0;
+    ADC0.INTFLAGS = ADC_RESRDY_bm;
+#if EVERYIBUS_ADC_USE_ISR
+    ADC0.INTCTRL = ADC_RESRDY_bm;
+#else
+    ADC0.INTCTRL = 0;
+#endif
+    selectChannel(0);
+
+    // One channel can simply free-run; a scan restarts after each harvest
+    uint8_t ctrla = ADC_ENABLE_bm;
+    if (_channelCount == 1 && !_eventTriggered) {
+        ctrla |= ADC_FREERUN_bm;
+    }
+    ADC0.CTRLA = ctrla;
+
+    if (!_eventTriggered) {
+        ADC0.COMMAND = ADC_STCONV_bm;
+    }
+}
+
+void EveryIBusADC::selectChannel(uint8_t index) {
+    const ADCChannel& channel = _channels[index];
+    uint8_t ctrlc = ADC0.CTRLC & ADC_PRESC_gm;  // Keep the core's ADC clock
+    uint8_t vref = VREF.CTRLA & ~VREF_ADC0REFSEL_gm;
+
+    switch (channel.reference) {
+        case IBUS_ADC_REF_0V55: vref |= VREF_ADC0REFSEL_0V55_gc; break;
+        case IBUS_ADC_REF_1V1:  vref |= VREF_ADC0REFSEL_1V1_gc;  break;
+        case IBUS_ADC_REF_2V5:  vref |= VREF_ADC0REFSEL_2V5_gc;  break;
+        case IBUS_ADC_REF_4V3:  vref |= VREF_ADC0REFSEL_4V34_gc; break;
+    }
+
+    if (channel.reference == IBUS_ADC_REF_VDD) {
+        ctrlc |= ADC_REFSEL_VDDREF_gc | ADC_SAMPCAP_bm;
+    } else {
+        ctrlc |= ADC_REFSEL_INTREF_gc;
+        if (channel.reference != IBUS_ADC_REF_0V55) {
+            ctrlc |= ADC_SAMPCAP_bm;  // Recommended for references above 1V
+        }
+        VREF.CTRLA = vref;
+    }
+
+    ADC0.CTRLC = ctrlc;
+    ADC0.SAMPCTRL = (channel.muxpos == ADC_MUXPOS_TEMPSENSE_gc) ? TEMPSENSE_SAMPLEN : 0;
+    ADC0.MUXPOS = channel.muxpos;
+}
+
+void EveryIBusADC::computeScale(uint8_t index) {
+    ADCChannel& channel = _channels[index];
+
+    if (channel.muxpos == ADC_MUXPOS_DACREF_gc) {
+        // 0.01V = level / 100 * 1023 * 2^n / accum - keep the numerator
+        channel.scale = (((uint32_t)channel.fullScale * 1023UL) << _sampleBits) / 100;
+    } else {
+        // 0.01V = accum * fullScale / (1023 * 2^n), as a 16.16 multiplier
+        channel.scale = ((uint32_t)channel.fullScale << 16) / (1023UL << _sampleBits);
+    }
+}
+
+void EveryIBusADC::harvest(uint16_t accum) {
+    ADCChannel& channel = _channels[_current];
+    _lastAccum[_current] = accum;
+
+    switch (channel.muxpos) {
+        case ADC_MUXPOS_DACREF_gc:
+            channel.value = accum ? (uint16_t)(channel.scale / accum) : 0;
+            break;
+        case ADC_MUXPOS_TEMPSENSE_gc:
+            channel.value = temperatureFromAccum(accum);
+            break;
+        default:
+            channel.value = (uint16_t)(((uint32_t)accum * channel.scale) >> 16);
+            break;
+    }
+
+    // Move on to the next input of the scan
+    if (_channelCount > 1) {
+        if (++_current >= _channelCount) _current = 0;
+        selectChannel(_current);
+        if (!_eventTriggered) {
+            ADC0.COMMAND = ADC_STCONV_bm;
+        }
+    }
+}
+
+uint16_t EveryIBusADC::temperatureFromAccum(uint16_t accum) const {
+    // Datasheet: K = ((result - TEMPSENSE1) * TEMPSENSE0 + 0x80) >> 8,
+    // applied to the accumulated result and scaled to 0.1K
+    int8_t offset = (int8_t)SIGROW.TEMPSENSE1;
+    uint8_t gain = SIGROW.TEMPSENSE0;
+
+    int32_t delta = (int32_t)accum - ((int32_t)offset << _sampleBits);
+    if (delta < 0) delta = 0;
+
+    uint8_t shift = 8 + _sampleBits;
+    uint32_t deciKelvin = ((uint32_t)delta * gain * 10UL + (1UL << (shift - 1))) >> shift;
+
+    // iBUS temperature: 0.1°C units where 0 = -40°C, i.e. 233.15K
+    return deciKelvin > 2332 ? (uint16_t)(deciKelvin - 2332) : 0;
+}
+
+#endif // ADC0 && VREF
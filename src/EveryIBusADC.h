@@ -0,0 +1,114 @@
+/*
+  EveryIBusADC.h - Background voltage sampling for EveryIBus
+
+  Owns ADC0 and scans up to EVERYIBUS_ADC_MAX_CHANNELS inputs with
+  hardware accumulation (SAMPNUM). Results are scaled to 0.01V with
+  integer math and published straight into the sensor slots, so loop()
+  never waits for a conversion.
+
+  Usage:
+  EveryIBus ibus;
+  EveryIBusADC adc;
+
+  void setup() {
+    ibus.begin();
+    // A0 behind a 1:3 divider on the 5V reference reads 15.00V at full scale
+    adc.addChannel(A0, IBUS_SENSOR_EXTERNAL_VOLTAGE, 1500);
+    adc.begin();
+  }
+
+  void loop() {
+    ibus.update();
+    adc.update(ibus);
+  }
+
+  The supply voltage and the die temperature can be scanned as well,
+  without any external parts:
+    adc.addSupplyVoltage();    // IntV from VDD against the internal reference
+    adc.addTemperature();      // Temp from the on-die sensor (SIGROW calibrated)
+
+  A single channel runs in free-running mode; several channels are
+  converted one after the other. Conversions can instead be started by an
+  event (e.g. the RTC PIT) with beginEvent(). ADC0 is not available to
+  analogRead() while the sampler runs.
+*/
+
+#ifndef EVERYIBUS_ADC_H
+#define EVERYIBUS_ADC_H
+
+#include "EveryIBus.h"
+
+#if defined(ADC0) && defined(VREF)
+
+// ADC references
+#define IBUS_ADC_REF_VDD             0
+#define IBUS_ADC_REF_0V55            1
+#define IBUS_ADC_REF_1V1             2
+#define IBUS_ADC_REF_2V5             3
+#define IBUS_ADC_REF_4V3             4
+
+struct ADCChannel {
+    uint8_t muxpos;
+    uint8_t reference;
+    uint8_t sensorType;
+    uint16_t fullScale;   // 0.01V at full ADC code (VDD: DACREF level in 0.1mV)
+    uint32_t scale;       // 0.01V per accumulated count, 16.16 fixed point
+                          // (VDD: 0.01V * accumulated count)
+    uint16_t value;       // Last result in 0.01V
+};
+
+class EveryIBusADC {
+public:
+    EveryIBusADC();
+
+    // fullScale: input voltage (0.01V units) that gives the full ADC code,
+    // i.e. reference voltage times the divider ratio
+    bool addChannel(uint8_t pin, uint8_t sensorType, uint16_t fullScale,
+                    uint8_t reference = IBUS_ADC_REF_VDD);
+
+    // Built-in sources - no external parts needed. VDD is measured through
+    // AC0's DACREF (VREF AC0REFSEL is set to 1.1V while the sampler runs).
+    bool addSupplyVoltage(uint8_t sensorType = IBUS_SENSOR_INTERNAL_VOLTAGE);
+    bool addTemperature(uint8_t sensorType = IBUS_SENSOR_TEMPERATURE);
+
+    // Start sampling; each result accumulates 2^sampleBits conversions (0-6)
+    void begin(uint8_t sampleBits = 4);
+
+    // Start a conversion on each event of an already routed event channel
+    void beginEvent(uint8_t eventChannel, uint8_t sampleBits = 4);
+
+    // Publish finished results - call from loop()
+    void update(EveryIBus& ibus);
+
+    // Correct the scale so the current reading matches a measured voltage
+    void calibrate(uint8_t channel, uint16_t actualVoltage);
+
+    uint16_t getValue(uint8_t channel) const { return _channels[channel].value; }
+    uint8_t getChannelCount() const { return _channelCount; }
+
+#if EVERYIBUS_ADC_USE_ISR
+    void handleInterrupt();
+#endif
+
+private:
+    ADCChannel _channels[EVERYIBUS_ADC_MAX_CHANNELS];
+    uint8_t _channelCount;
+    uint8_t _current;
+    uint8_t _sampleBits;
+    bool _eventTriggered;
+    bool _needsDacref;
+    uint16_t _lastAccum[EVERYIBUS_ADC_MAX_CHANNELS];
+#if EVERYIBUS_ADC_USE_ISR
+    volatile uint8_t _fresh;   // Bit per channel with an unpublished result
+#endif
+
+    void start(uint8_t sampleBits);
+    void selectChannel(uint8_t index);
+    void computeScale(uint8_t index);
+    void harvest(uint16_t accum);
+    uint16_t temperatureFromAccum(uint16_t accum) const;
+};
+
+#endif // ADC0 && VREF
+
+#endif // EVERYIBUS_ADC_H
@@ -0,0 +1,228 @@
+/*
+  EveryIBusCRSF.cpp - CRSF telemetry (ELRS, Crossfire) from the EveryIBus sensor table
+
+  Frames on the wire: sync, length (type + payload + CRC), type, payload
+  (big-endian), CRC8 over type and payload. The CRC of a received frame
+  is updated per byte as it arrives, so no frame is ever buffered.
+*/
+
+#include "EveryIBusCRSF.h"
+
+// Telemetry frames in rotation order
+static const uint8_t telemetryFrames[] = {
+    CRSF_FRAME_BATTERY, CRSF_FRAME_BARO_ALTITUDE, CRSF_FRAME_VARIO, CRSF_FRAME_GPS
+};
+#define CRSF_TELEMETRY_KINDS ((uint8_t)(sizeof(telemetryFrames) / sizeof(telemetryFrames[0])))
+
+static void put16(uint8_t* out, uint16_t value) {
+    out[0] = value >> 8;
+    out[1] = value & 0xFF;
+}
+
+#if EVERYIBUS_WIDE_SENSORS
+static void put32(uint8_t* out, uint32_t value) {
+    put16(out, value >> 16);
+    put16(out + 2, value & 0xFFFF);
+}
+#endif
+
+EveryIBusCRSF::EveryIBusCRSF() {
+    _sensors = nullptr;
+    _serial = nullptr;
+    _rxPos = 0;
+    _rxLength = 0;
+    _rxType = 0;
+    _rxCrc = 0;
+    _nextFrame = 0;
+    _channelFrames = 0;
+    _telemetryFrames = 0;
+    _skipped = 0;
+}
+
+void EveryIBusCRSF::begin(EveryIBus& sensors, HardwareSerial& port, uint32_t baud) {
+    _sensors = &sensors;
+    _serial = &port;
+    _serial->begin(baud);
+}
+
+void EveryIBusCRSF::update() {
+    if (!_serial) return;
+
+    uint8_t budget = _sensors->_byteBudget;
+    while (budget && _serial->available()) {
+        receive(_serial->read());
+        budget--;
+    }
+}
+
+void EveryIBusCRSF::receive(uint8_t data) {
+    // Hunt for the sync byte, then a plausible length
+    if (_rxPos == 0) {
+        if (data == CRSF_SYNC_BYTE) _rxPos = 1;
+        return;
+    }
+    if (_rxPos == 1) {
+        if (data < 2 || data > CRSF_MAX_FRAME_LEN - 2) {
+            _rxPos = 0;
+            return;
+        }
+        _rxLength = data;
+        _rxCrc = 0;
+        _rxPos = 2;
+        return;
+    }
+
+    uint8_t index = _rxPos - 2;   // 0 = type, _rxLength - 1 = CRC
+    _rxPos++;
+    if (index == 0) _rxType = data;
+    if (index + 1 < _rxLength) {
+        _rxCrc = crc8(_rxCrc, data);
+        return;
+    }
+
+    // Complete frame; a bad one just means hunting for the next sync
+    _rxPos = 0;
+    if (data == _rxCrc && _rxType == CRSF_FRAME_RC_CHANNELS) {
+        _channelFrames++;
+        sendTelemetry();
+    }
+}
+
+void EveryIBusCRSF::sendTelemetry() {
+    // One frame per RC frame: that is the slot the link leaves for us
+#if EVERYIBUS_BATCH
+    if (_sensors->_batching) return;   // Values are only half updated
+#endif
+    uint8_t frame[CRSF_MAX_FRAME_LEN];
+    for (uint8_t n = 0; n < CRSF_TELEMETRY_KINDS; n++) {
+        uint8_t kind = _nextFrame;
+        _nextFrame = (_nextFrame + 1 < CRSF_TELEMETRY_KINDS) ? _nextFrame + 1 : 0;
+
+        uint8_t length = buildFrame(telemetryFrames[kind], frame);
+        if (!length) continue;
+
+        if (_serial->availableForWrite() < length) {
+            // Never wait here - retry this frame in the next slot
+            _nextFrame = kind;
+            _skipped++;
+            return;
+        }
+        _serial->write(frame, length);
+        _telemetryFrames++;
+        return;
+    }
+}
+
+uint8_t EveryIBusCRSF::buildFrame(uint8_t kind, uint8_t* frame) {
+    uint8_t* payload = frame + 3;
+    uint8_t payloadLength;
+    int32_t value;
+
+    switch (kind) {
+        case CRSF_FRAME_BATTERY: {
+            if (!readSensor(IBUS_SENSOR_EXTERNAL_VOLTAGE, value)) return 0;
+            put16(payload, value / 10);                       // 0.01V -> 0.1V
+
+            int32_t current = 0;
+            readSensor(IBUS_SENSOR_CURRENT, current);
+            put16(payload + 2, current / 10);                 // 0.01A -> 0.1A
+
+            int32_t fuel;
+            uint32_t mAh = readSensor(IBUS_SENSOR_FUEL, fuel) ? (uint32_t)fuel : _sensors->getConsumedMah();
+            if (mAh > 0xFFFFFF) mAh = 0xFFFFFF;
+            payload[4] = mAh >> 16;
+            put16(payload + 5, mAh & 0xFFFF);
+            payload[7] = 0;                                   // Remaining % unknown
+            payloadLength = 8;
+            break;
+        }
+        case CRSF_FRAME_VARIO:
+            if (!readSensor(IBUS_SENSOR_CLIMB_RATE, value)) return 0;
+            put16(payload, (uint16_t)(int16_t)value);         // Signed cm/s
+            payloadLength = 2;
+            break;
+#if EVERYIBUS_WIDE_SENSORS
+        case CRSF_FRAME_BARO_ALTITUDE: {
+            if (!readSensor(IBUS_SENSOR_ALTITUDE, value)) return 0;
+
+            // dm + 10000 up to 2276.7m, above that whole metres with bit 15 set
+            int32_t dm = value / 10;
+            uint16_t packed;
+            if (dm < -10000) {
+                packed = 0;
+            } else if (dm < 0x8000 - 10000) {
+                packed = dm + 10000;
+            } else {
+                int32_t m = value / 100;
+                packed = 0x8000 | (m > 0x7FFF ? 0x7FFF : m);
+            }
+            put16(payload, packed);
+            payloadLength = 2;
+            break;
+        }
+        case CRSF_FRAME_GPS: {
+            int32_t lat, lon;
+            if (!readSensor(IBUS_SENSOR_GPS_LAT, lat) || !readSensor(IBUS_SENSOR_GPS_LON, lon)) return 0;
+            put32(payload, lat);                              // 1e-7 degrees
+            put32(payload + 4, lon);
+            put16(payload + 8, 0);                            // Ground speed unknown
+
+            int32_t heading = 0;
+            readSensor(IBUS_SENSOR_HEADING, heading);
+            put16(payload + 10, heading * 100);               // 0.01 degrees
+
+            int32_t altitude = 0;
+            readSensor(IBUS_SENSOR_GPS_ALT, altitude);
+            put16(payload + 12, altitude / 100 + 1000);       // m + 1000
+            payload[14] = 0;                                  // Satellites unknown
+            payloadLength = 15;
+            break;
+        }
+#endif
+        default:
+            return 0;
+    }
+
+    frame[0] = CRSF_SYNC_BYTE;
+    frame[1] = payloadLength + 2;    // Type + payload + CRC
+    frame[2] = kind;
+
+    uint8_t crc = 0;
+    for (uint8_t i = 2; i < payloadLength + 3; i++) {
+        crc = crc8(crc, frame[i]);
+    }
+    frame[payloadLength + 3] = crc;
+    return payloadLength + 4;
+}
+
+bool EveryIBusCRSF::readSensor(uint8_t sensorType, int32_t& value) {
+    // First slot of the type with a value, as the type-keyed setters use
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        const Sensor& sensor = _sensors->_sensors[i];
+        if (sensor.type != sensorType || !sensor.hasValue) continue;
+
+        value = sensor.value;
+#if EVERYIBUS_WIDE_SENSORS
+        if (sensorType >= IBUS_SENSOR_WIDE_FIRST) {
+            value = (int32_t)(((uint32_t)sensor.valueHigh << 16) | sensor.value);
+        }
+#endif
+#if EVERYIBUS_STALENESS
+        if (sensor.maxAge && (millis() - sensor.updatedAt) > sensor.maxAge) {
+            if (sensor.staleMode == IBUS_STALE_SILENT) return false;
+            value = sensor.failsafeValue;
+        }
+#endif
+        return true;
+    }
+    return false;
+}
+
+uint8_t EveryIBusCRSF::crc8(uint8_t crc, uint8_t data) {
+    // Bitwise instead of a 256-byte table: at most ~60 bytes per RC frame
+    crc ^= data;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x80) ? (crc << 1) ^ CRSF_CRC_POLY : crc << 1;
+    }
+    return crc;
+}
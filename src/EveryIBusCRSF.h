@@ -0,0 +1,89 @@
+/*
+  EveryIBusCRSF.h - CRSF telemetry (ELRS, Crossfire) from the EveryIBus sensor table
+
+  Connects to the UART of a CRSF receiver the way a flight controller
+  does: the receiver streams RC channel frames, and each one opens a
+  telemetry slot in which we send one frame back. The frames are packed
+  from the sensor slots at that moment, in turn:
+    Battery (0x08)   external voltage, current, consumed mAh
+    Baro     (0x09)  IBUS_SENSOR_ALTITUDE
+    Vario    (0x07)  climb rate
+    GPS      (0x02)  GPS lat/lon, GPS altitude, heading
+  A frame whose sensors have no value is left out of the rotation.
+
+  Usage:
+  EveryIBus ibus;              // Sensor table (no begin() needed)
+  EveryIBusCRSF crsf;
+
+  void setup() {
+    crsf.begin(ibus);          // Serial1 at 420000 baud
+  }
+
+  void loop() {
+    crsf.update();
+    ibus.setExternalVoltage(12.41);
+  }
+
+  Wiring: receiver TX -> D0 (RX), receiver RX -> D1 (TX), no resistor.
+  At 420000 baud an RC frame arrives every few ms, so update() must run
+  often enough to read 26 bytes per frame within its byte budget
+  (setUpdateBudget() on the EveryIBus instance).
+*/
+
+#ifndef EVERYIBUS_CRSF_H
+#define EVERYIBUS_CRSF_H
+
+#include "EveryIBus.h"
+
+#define CRSF_BAUD                 420000
+#define CRSF_SYNC_BYTE            0xC8   // Address of the flight controller
+#define CRSF_CRC_POLY             0xD5
+#define CRSF_MAX_FRAME_LEN        64     // Sync + length + up to 62 bytes
+
+#define CRSF_FRAME_GPS            0x02
+#define CRSF_FRAME_VARIO          0x07
+#define CRSF_FRAME_BATTERY        0x08
+#define CRSF_FRAME_BARO_ALTITUDE  0x09
+#define CRSF_FRAME_RC_CHANNELS    0x16
+
+class EveryIBusCRSF {
+public:
+    EveryIBusCRSF();
+
+    // Values come from the slots of sensors, which can also run its own
+    // iBUS port at the same time
+    void begin(EveryIBus& sensors, HardwareSerial& port = Serial1, uint32_t baud = CRSF_BAUD);
+
+    // Call from loop() - reads at most the EveryIBus byte budget per call
+    // and never waits for the TX buffer
+    void update();
+
+    uint32_t getChannelFrameCount() const { return _channelFrames; }
+    uint32_t getTelemetryCount() const { return _telemetryFrames; }
+    uint32_t getSkipCount() const { return _skipped; }   // Slots missed, TX buffer full
+
+    // Protocol helper: CRC8 (poly 0xD5) of one more byte
+    static uint8_t crc8(uint8_t crc, uint8_t data);
+
+private:
+    EveryIBus* _sensors;
+    HardwareSerial* _serial;
+
+    // Resumable receive state - only the CRC and type are kept
+    uint8_t _rxPos;              // Bytes of the current frame seen, 0 = hunting
+    uint8_t _rxLength;           // Length byte of the current frame
+    uint8_t _rxType;
+    uint8_t _rxCrc;
+
+    uint8_t _nextFrame;          // Telemetry rotation
+    uint32_t _channelFrames;
+    uint32_t _telemetryFrames;
+    uint32_t _skipped;
+
+    void receive(uint8_t data);
+    void sendTelemetry();
+    uint8_t buildFrame(uint8_t kind, uint8_t* frame);
+    bool readSensor(uint8_t sensorType, int32_t& value);
+};
+
+#endif // EVERYIBUS_CRSF_H
@@ -0,0 +1,104 @@
+/*
+  EveryIBusConfig.h - Compile-time configuration for EveryIBus
+  
+  Every option can be overridden with a build flag (e.g. PlatformIO
+  build_flags = -DEVERYIBUS_FILTER_MEDIAN=0) or by editing the
+  defaults below. Features that are switched off add no flash or RAM.
+*/
+
+#ifndef EVERYIBUS_CONFIG_H
+#define EVERYIBUS_CONFIG_H
+
+// Maximum number of sensors we support. Each slot needs a bus address
+// of its own (IBUS_MAX_ADDRESS, 1-15) and a bit in the 16-bit slot masks.
+#ifndef MAX_SENSORS
+#define MAX_SENSORS 6
+#endif
+
+static_assert(MAX_SENSORS >= 1 && MAX_SENSORS <= 15, "MAX_SENSORS must be 1-15, one bus address per slot");
+
+// Maximum number of buses an EveryIBusGroup can service
+#ifndef MAX_BUSES
+#define MAX_BUSES 4
+#endif
+
+// Byte transport the protocol core talks through (EveryIBusTransport.h)
+#ifndef EVERYIBUS_TRANSPORT
+#define EVERYIBUS_TRANSPORT EveryIBusSerialTransport
+#endif
+
+// Debug output levels: 0 compiles all debug code and strings out,
+// 1 keeps warnings, 2 adds a protocol trace. setDebug() only exists in
+// debug builds (level 1 or 2); output is still off until it is called.
+// Off by default, so a flight build carries none of it; raise it here
+// (or with -DEVERYIBUS_DEBUG=2) while bringing a setup up.
+#define IBUS_DEBUG_OFF   0
+#define IBUS_DEBUG_WARN  1
+#define IBUS_DEBUG_TRACE 2
+
+#ifndef EVERYIBUS_DEBUG
+#define EVERYIBUS_DEBUG IBUS_DEBUG_OFF
+#endif
+
+// Bytes update() reads from the serial port per call at most. Parsing
+// resumes on the next call, so the cost of one call stays bounded no
+// matter what is on the wire. A poll plus our echoed reply is 10 bytes
+// (12 for a 4-byte sensor) per ~7ms poll cycle, so at the default 8
+// update() must run at least every ~3ms.
+#ifndef EVERYIBUS_UPDATE_BUDGET
+#define EVERYIBUS_UPDATE_BUDGET 8
+#endif
+
+// Per-slot filter stages applied between setSensorValue() and the
+// reported value: median-of-N, then integer EMA, then slew limiting
+#ifndef EVERYIBUS_FILTER_MEDIAN
+#define EVERYIBUS_FILTER_MEDIAN 1
+#endif
+
+#ifndef EVERYIBUS_FILTER_EMA
+#define EVERYIBUS_FILTER_EMA 1
+#endif
+
+#ifndef EVERYIBUS_FILTER_SLEW
+#define EVERYIBUS_FILTER_SLEW 1
+#endif
+
+// Window of the median filter (3 or 5 samples)
+#ifndef EVERYIBUS_MEDIAN_SIZE
+#define EVERYIBUS_MEDIAN_SIZE 3
+#endif
+
+// Per-sensor maximum age with failsafe handling (setMaxAge())
+#ifndef EVERYIBUS_STALENESS
+#define EVERYIBUS_STALENESS 1
+#endif
+
+// Batched updates (beginBatch()/commitBatch()): a second frame buffer
+// per slot, so related values go live together
+#ifndef EVERYIBUS_BATCH
+#define EVERYIBUS_BATCH 1
+#endif
+
+// 4-byte sensor types (IBUS_SENSOR_GPS_*, IBUS_SENSOR_ALTITUDE...):
+// 2 more value bytes per slot and 8-byte response frames
+#ifndef EVERYIBUS_WIDE_SENSORS
+#define EVERYIBUS_WIDE_SENSORS 1
+#endif
+
+// Per-sensor threshold alarms evaluated in setSensorValue() (setAlarm())
+#ifndef EVERYIBUS_ALARMS
+#define EVERYIBUS_ALARMS 1
+#endif
+
+// Number of inputs EveryIBusADC can scan
+#ifndef EVERYIBUS_ADC_MAX_CHANNELS
+#define EVERYIBUS_ADC_MAX_CHANNELS 4
+#endif
+
+// Harvest ADC results in the ADC0 RESRDY interrupt instead of polling
+// from update(). Off by default so the vector stays free for sketches.
+#ifndef EVERYIBUS_ADC_USE_ISR
+#define EVERYIBUS_ADC_USE_ISR 0
+#endif
+
+#endif // EVERYIBUS_CONFIG_H
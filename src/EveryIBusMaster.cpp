@@ -0,0 +1,316 @@
+/*
+  EveryIBusMaster.cpp - Receiver side of an iBUS sensor bus
+
+  One poll is outstanding at a time. A reply that completes it, or its
+  timeout, sends the next poll right away from the same update() call.
+*/
+
+#include "EveryIBusMaster.h"
+
+EveryIBusMaster::EveryIBusMaster() {
+    _pollCommand = 0;
+    _pollAddress = 0;
+    _pollSentAt = 0;
+    _cursor = IBUS_MAX_ADDRESS;      // First poll wraps and starts with a probe
+    _probeAddress = IBUS_MAX_ADDRESS;
+    _unpublished = 0;
+    _released = 0;
+    _dropMode = IBUS_REMOVE_SILENT;
+    _dropFailsafe = 0;
+    _rxLen = 0;
+    _echoSkip = 0;
+    _skipEcho = true;
+    _byteBudget = EVERYIBUS_UPDATE_BUDGET;
+    _pollCount = 0;
+    _replyCount = 0;
+    _timeoutCount = 0;
+
+    for (int i = 0; i < IBUS_MAX_ADDRESS; i++) {
+        _remotes[i].present = false;
+        _remotes[i].type = 0xFF;
+        _remotes[i].size = 0;
+        _remotes[i].misses = 0;
+        _remotes[i].value = 0;
+        _remotes[i].updatedAt = 0;
+        _remotes[i].hasValue = false;
+        _remotes[i].forwardSlot = IBUS_NO_SLOT;
+    }
+}
+
+void EveryIBusMaster::begin(Transport::Port& port) {
+    _port.begin(port);
+
+    // Sensors ignore anything before their own startup delay
+    delay(100);
+    while (_port.available()) {
+        _port.read();
+    }
+}
+
+void EveryIBusMaster::update() {
+    if (!_port.isOpen()) return;
+
+    uint8_t budget = _byteBudget;
+    while (budget && _port.available()) {
+        receive(_port.read());
+        budget--;
+    }
+
+    // Bytes still waiting may be the reply: a slow loop is no timeout
+    if (_pollCommand && !_port.available() && micros() - _pollSentAt > IBUS_MASTER_REPLY_TIMEOUT_US) {
+        handleTimeout();
+        _rxLen = 0;
+        _echoSkip = 0;
+    }
+
+    if (!_pollCommand) {
+        sendNextPoll();
+    }
+}
+
+void EveryIBusMaster::receive(uint8_t data) {
+    // Our poll comes back through the TX resistor - skip it
+    if (_echoSkip) {
+        _echoSkip--;
+        return;
+    }
+
+    if (_rxLen == 0 && (data < IBUS_MIN_FRAME_LEN || data > IBUS_MAX_FRAME_LEN)) {
+        return;
+    }
+
+    _rxBuf[_rxLen++] = data;
+    if (_rxLen < _rxBuf[0]) return;
+
+    _rxLen = 0;
+    handleReply(_rxBuf);
+}
+
+void EveryIBusMaster::handleReply(const uint8_t* frame) {
+    uint8_t length = frame[0];
+    uint16_t checksum = EveryIBus::calculateChecksum(frame, length - 2);
+    if (frame[length - 2] != (checksum & 0xFF) || frame[length - 1] != (checksum >> 8)) {
+        return;
+    }
+
+    // Only the reply to the outstanding poll counts
+    uint8_t command = frame[1] & 0xF0;
+    uint8_t address = frame[1] & 0x0F;
+    if (!_pollCommand || command != _pollCommand || address != _pollAddress) {
+        return;
+    }
+
+    IBusRemoteSensor& remote = *remoteFor(address);
+    _replyCount++;
+    _pollCommand = 0;
+
+    switch (command) {
+        case IBUS_CMD_DISCOVER:
+            // Ask for the type next, before anything else
+            if (length == IBUS_MIN_FRAME_LEN) {
+                sendPoll(IBUS_CMD_TYPE, address);
+                return;
+            }
+            break;
+
+        case IBUS_CMD_TYPE:
+            // Only 2- and 4-byte values can be decoded
+            if (length == 6 && (frame[3] == 2 || frame[3] == 4)) {
+                if (remote.type != frame[2] || remote.size != frame[3]) {
+                    // Another sensor took the address: new slot on publish
+                    releaseSlot(address);
+                    remote.type = frame[2];
+                    remote.size = frame[3];
+                }
+                remote.present = true;
+                remote.misses = 0;
+                remote.hasValue = false;
+            }
+            break;
+
+        case IBUS_CMD_MEASUREMENT:
+            if (length != remote.size + 4) {
+                // Not the sensor TYPE told us about - ask again right away
+                sendPoll(IBUS_CMD_TYPE, address);
+                return;
+            }
+            if (remote.size == 4) {
+                remote.value = (int32_t)((uint32_t)frame[2] | ((uint32_t)frame[3] << 8) |
+                                         ((uint32_t)frame[4] << 16) | ((uint32_t)frame[5] << 24));
+            } else {
+                remote.value = frame[2] | (frame[3] << 8);
+            }
+            remote.updatedAt = millis();
+            remote.hasValue = true;
+            remote.misses = 0;
+            _unpublished |= (1u << address);
+            break;
+    }
+
+    // Pipelined: the line is free again, poll the next sensor now
+    sendNextPoll();
+}
+
+void EveryIBusMaster::handleTimeout() {
+    IBusRemoteSensor& remote = *remoteFor(_pollAddress);
+    _timeoutCount++;
+
+    // A silent DISCOVER is just a free address; a sensor that stops
+    // answering is dropped and found again by a later probe
+    if (_pollCommand == IBUS_CMD_TYPE ||
+        (_pollCommand == IBUS_CMD_MEASUREMENT && ++remote.misses >= IBUS_MASTER_MAX_MISSES)) {
+        remote.present = false;
+        releaseSlot(_pollAddress);
+    }
+    _pollCommand = 0;
+}
+
+void EveryIBusMaster::releaseSlot(uint8_t address) {
+    // publishTo() removes it, so the receiver doesn't keep a frozen value
+    if (remoteFor(address)->forwardSlot != IBUS_NO_SLOT) {
+        _released |= (1u << address);
+    }
+    _unpublished &= ~(1u << address);
+}
+
+void EveryIBusMaster::sendNextPoll() {
+    // Present sensors round-robin, one DISCOVER probe per round
+    for (uint8_t n = 0; n <= IBUS_MAX_ADDRESS; n++) {
+        if (_cursor >= IBUS_MAX_ADDRESS) {
+            _cursor = 0;
+            if (sendProbe()) return;
+        }
+        _cursor++;
+        if (remoteFor(_cursor)->present) {
+            sendPoll(IBUS_CMD_MEASUREMENT, _cursor);
+            return;
+        }
+    }
+}
+
+bool EveryIBusMaster::sendProbe() {
+    for (uint8_t n = 0; n < IBUS_MAX_ADDRESS; n++) {
+        if (++_probeAddress > IBUS_MAX_ADDRESS) _probeAddress = 1;
+        if (!remoteFor(_probeAddress)->present) {
+            sendPoll(IBUS_CMD_DISCOVER, _probeAddress);
+            return true;
+        }
+    }
+    return false;  // All 15 addresses answer
+}
+
+void EveryIBusMaster::sendPoll(uint8_t command, uint8_t address) {
+    uint8_t poll[IBUS_MIN_FRAME_LEN];
+    poll[0] = IBUS_MIN_FRAME_LEN;
+    poll[1] = command | address;
+    uint16_t checksum = EveryIBus::calculateChecksum(poll, 2);
+    poll[2] = checksum & 0xFF;
+    poll[3] = checksum >> 8;
+
+    _port.write(poll, sizeof(poll));
+    if (_skipEcho) {
+        _echoSkip += sizeof(poll);
+    }
+
+    _pollCommand = command;
+    _pollAddress = address;
+    _pollSentAt = micros();
+    _pollCount++;
+}
+
+void EveryIBusMaster::publishTo(EveryIBus& bus) {
+    if (!_unpublished && !_released) return;
+
+    // Slots of sensors that are gone or were swapped for another type.
+    // The failsafe frame only makes sense for the type it was set up as.
+    for (uint8_t address = 1; _released && address <= IBUS_MAX_ADDRESS; address++) {
+        if (!(_released & (1u << address))) continue;
+        _released &= ~(1u << address);
+
+        IBusRemoteSensor& remote = *remoteFor(address);
+        if (remote.present) {
+            bus.removeSensor(remote.forwardSlot, IBUS_REMOVE_SILENT);
+        } else {
+            bus.removeSensor(remote.forwardSlot, _dropMode, _dropFailsafe);
+        }
+        remote.forwardSlot = IBUS_NO_SLOT;
+    }
+    if (!_unpublished) return;
+
+#if EVERYIBUS_BATCH
+    // A polling round goes live as one set
+    bus.beginBatch();
+#endif
+    for (uint8_t address = 1; address <= IBUS_MAX_ADDRESS; address++) {
+        if (!(_unpublished & (1u << address))) continue;
+
+        IBusRemoteSensor& remote = *remoteFor(address);
+        if (remote.forwardSlot == IBUS_NO_SLOT) {
+            EveryIBusSensor handle = bus.addSensor(remote.type);
+            if (!handle.isValid()) continue;   // Retried on the next value
+            remote.forwardSlot = handle.getSlot();
+        }
+
+#if EVERYIBUS_WIDE_SENSORS
+        if (remote.type >= IBUS_SENSOR_WIDE_FIRST) {
+            bus.setSlotWideValue(remote.forwardSlot, remote.value);
+            continue;
+        }
+#endif
+        bus.setSlotValue(remote.forwardSlot, (uint16_t)remote.value);
+    }
+#if EVERYIBUS_BATCH
+    bus.commitBatch();
+#endif
+    _unpublished = 0;
+}
+
+uint8_t EveryIBusMaster::getSensorCount() const {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < IBUS_MAX_ADDRESS; i++) {
+        if (_remotes[i].present) count++;
+    }
+    return count;
+}
+
+bool EveryIBusMaster::isPresent(uint8_t address) const {
+    const IBusRemoteSensor* remote = remoteFor(address);
+    return remote && remote->present;
+}
+
+uint8_t EveryIBusMaster::getType(uint8_t address) const {
+    const IBusRemoteSensor* remote = remoteFor(address);
+    return remote ? remote->type : 0xFF;
+}
+
+int32_t EveryIBusMaster::getValue(uint8_t address) const {
+    const IBusRemoteSensor* remote = remoteFor(address);
+    return remote ? remote->value : 0;
+}
+
+uint32_t EveryIBusMaster::getAge(uint8_t address) const {
+    const IBusRemoteSensor* remote = remoteFor(address);
+    if (!remote || !remote->hasValue) return 0xFFFFFFFF;
+    return millis() - remote->updatedAt;
+}
+
+bool EveryIBusMaster::isFresh(uint8_t address, uint32_t maxAgeMs) const {
+    return isPresent(address) && getAge(address) <= maxAgeMs;
+}
+
+uint8_t EveryIBusMaster::findSensor(uint8_t sensorType, uint8_t after) const {
+    for (uint8_t address = after + 1; address <= IBUS_MAX_ADDRESS; address++) {
+        if (_remotes[address - 1].present && _remotes[address - 1].type == sensorType) {
+            return address;
+        }
+    }
+    return 0;
+}
+
+IBusRemoteSensor* EveryIBusMaster::remoteFor(uint8_t address) {
+    return (address >= 1 && address <= IBUS_MAX_ADDRESS) ? &_remotes[address - 1] : nullptr;
+}
+
+const IBusRemoteSensor* EveryIBusMaster::remoteFor(uint8_t address) const {
+    return (address >= 1 && address <= IBUS_MAX_ADDRESS) ? &_remotes[address - 1] : nullptr;
+}
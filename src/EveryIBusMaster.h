@@ -0,0 +1,148 @@
+/*
+  EveryIBusMaster.h - Receiver side of an iBUS sensor bus
+
+  Polls third-party iBUS sensors (a GPS, a current sensor...) the way a
+  receiver does and keeps their decoded values for the sketch: DISCOVER
+  to find them, TYPE to learn what they are, then MEASUREMENT round-robin.
+  The polls are pipelined - the next one goes out as soon as a reply is
+  complete (or timed out) - and every reply is checksum-verified.
+
+  Usage:
+  EveryIBusMaster master;      // Sensors on Serial2
+  EveryIBus ibus;              // Our own sensor port to the receiver
+
+  void setup() {
+    master.begin(Serial2);
+    ibus.begin(Serial1);
+  }
+
+  void loop() {
+    master.update();
+    ibus.update();
+    master.publishTo(ibus);    // Hub: forward what was measured
+
+    uint8_t gps = master.findSensor(IBUS_SENSOR_GPS_LAT);
+    if (gps && master.isFresh(gps, 500)) {
+      int32_t lat = master.getValue(gps);
+    }
+  }
+
+  Wiring is the same as for a sensor (RX direct, TX through 1kΩ), so
+  our own polls come back on RX and are skipped.
+
+  Addresses that stop answering are dropped after a few misses and
+  probed again with one DISCOVER per polling round, so sensors can be
+  plugged in while running. A MEASUREMENT reply whose length doesn't
+  match the size from TYPE is dropped and TYPE is asked again, so a
+  sensor swapped at the same address is picked up with its new type.
+*/
+
+#ifndef EVERYIBUS_MASTER_H
+#define EVERYIBUS_MASTER_H
+
+#include "EveryIBus.h"
+
+// How long a sensor may take to start and finish its reply
+#ifndef IBUS_MASTER_REPLY_TIMEOUT_US
+#define IBUS_MASTER_REPLY_TIMEOUT_US  2000
+#endif
+
+// Missed MEASUREMENT replies in a row before an address counts as gone
+#define IBUS_MASTER_MAX_MISSES        8
+
+struct IBusRemoteSensor {
+    bool present;
+    uint8_t type;
+    uint8_t size;          // Value bytes from the TYPE reply (2 or 4)
+    uint8_t misses;
+    int32_t value;         // Raw iBUS units, sign-extended 4-byte values
+    uint32_t updatedAt;    // millis() of the last MEASUREMENT reply
+    bool hasValue;
+    uint8_t forwardSlot;   // publishTo() slot on the other bus
+};
+
+class EveryIBusMaster {
+public:
+    typedef EveryIBus::Transport Transport;
+
+    EveryIBusMaster();
+
+    void begin(Transport::Port& port = Transport::defaultPort());
+
+    // Call from loop() - reads at most the byte budget per call and sends
+    // at most one poll; never waits for a reply
+    void update();
+    void setUpdateBudget(uint8_t bytes) { _byteBudget = bytes ? bytes : 1; }
+
+    // Our polls come back on RX through the TX resistor and are skipped.
+    // Turn this off for wiring without that loopback (e.g. a pty).
+    void setEchoSkip(bool enable) { _skipEcho = enable; }
+
+    // Decoded value table, by bus address 1-15
+    uint8_t getSensorCount() const;
+    bool isPresent(uint8_t address) const;
+    uint8_t getType(uint8_t address) const;
+    int32_t getValue(uint8_t address) const;
+    uint32_t getAge(uint8_t address) const;               // ms, 0xFFFFFFFF = never measured
+    bool isFresh(uint8_t address, uint32_t maxAgeMs) const;
+
+    // First address with this sensor type after the given one, 0 = none
+    uint8_t findSensor(uint8_t sensorType, uint8_t after = 0) const;
+
+    // Sensor hub: every value measured since the last call is set on bus,
+    // each remote sensor in a slot of its own (addSensor() on first use).
+    // The slot of a sensor that was swapped for another type is removed.
+    // Always pass the same bus.
+    void publishTo(EveryIBus& bus);
+    
+    // What publishTo() does with the slot of a sensor that stopped
+    // answering: IBUS_REMOVE_SILENT (default) or IBUS_REMOVE_FAILSAFE
+    void setDropMode(uint8_t mode, uint16_t failsafeValue = 0) {
+        _dropMode = mode;
+        _dropFailsafe = failsafeValue;
+    }
+
+    // Optional: Get statistics
+    uint32_t getPollCount() const { return _pollCount; }
+    uint32_t getReplyCount() const { return _replyCount; }
+    uint32_t getTimeoutCount() const { return _timeoutCount; }
+
+private:
+    Transport _port;
+    IBusRemoteSensor _remotes[IBUS_MAX_ADDRESS];   // Address N at index N-1
+
+    // Outstanding poll, command 0 = none
+    uint8_t _pollCommand;
+    uint8_t _pollAddress;
+    uint32_t _pollSentAt;
+
+    uint8_t _cursor;             // Last address polled for a MEASUREMENT
+    uint8_t _probeAddress;       // Last address probed with DISCOVER
+    uint16_t _unpublished;       // Bit per address, measured since publishTo()
+    uint16_t _released;          // Bit per address, forwarded slot to remove
+    uint8_t _dropMode;
+    uint16_t _dropFailsafe;
+
+    // Resumable receive state, as in EveryIBus
+    uint8_t _rxBuf[IBUS_MAX_FRAME_LEN];
+    uint8_t _rxLen;
+    uint8_t _echoSkip;
+    bool _skipEcho;
+    uint8_t _byteBudget;
+
+    uint32_t _pollCount;
+    uint32_t _replyCount;
+    uint32_t _timeoutCount;
+
+    void receive(uint8_t data);
+    void handleReply(const uint8_t* frame);
+    void handleTimeout();
+    void releaseSlot(uint8_t address);
+    void sendNextPoll();
+    bool sendProbe();
+    void sendPoll(uint8_t command, uint8_t address);
+    IBusRemoteSensor* remoteFor(uint8_t address);
+    const IBusRemoteSensor* remoteFor(uint8_t address) const;
+};
+
+#endif // EVERYIBUS_MASTER_H
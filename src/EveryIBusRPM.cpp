@@ -0,0 +1,152 @@
+/*
+  EveryIBusRPM.cpp - Hardware RPM measurement for EveryIBus
+  
+  TCB frequency capture fed by the event system. Captures are harvested
+  by polling, so there is no per-pulse interrupt.
+*/
+
+#include "EveryIBusRPM.h"
+
+#if defined(TCB0) && defined(EVSYS)
+
+EveryIBusRPM::EveryIBusRPM(TCB_t& timer) {
+    _tcb = &timer;
+    _pulsesPerRev = 1;
+    _samples = 1;
+    _running = false;
+    _primed = false;
+    _rpmScale = 0;
+    _stallMs = 0;
+    _lastCapture = 0;
+    _rpm = 0;
+    reset();
+}
+
+bool EveryIBusRPM::begin(uint8_t pin, uint8_t pulsesPerRev, uint8_t samples) {
+    uint8_t port = digitalPinToPort(pin);
+    uint8_t bit = digitalPinToBitPosition(pin);
+    if (port == NOT_A_PIN || bit == NOT_A_PIN) return false;
+    
+    // Port generators: channels 0/1 see PORTA/PORTB, 2/3 see PORTC/PORTD
+    // and 4/5 see PORTE/PORTF - use the even channel of the pair
+    uint8_t channel = (port / 2) * 2;
+    uint8_t generator = EVSYS_GENERATOR_PORT0_PIN0_gc + ((port & 1) ? 8 : 0) + bit;
+    
+    pinMode(pin, INPUT);
+    (&EVSYS.CHANNEL0)[channel] = generator;
+    
+    return beginEvent(channel, pulsesPerRev, samples);
+}
+
+bool EveryIBusRPM::beginEvent(uint8_t channel, uint8_t pulsesPerRev, uint8_t samples) {
+    if (channel > 7 || pulsesPerRev == 0) return false;
+    if (!connectUser(channel)) return false;
+    
+    startTimer(pulsesPerRev, samples);
+    return true;
+}
+
+void EveryIBusRPM::update(EveryIBus& ibus) {
+    if (!_running) return;
+    
+    uint32_t now = millis();
+    
+    if (_tcb->INTFLAGS & TCB_CAPT_bm) {
+        uint16_t period = _tcb->CCMP;     // Latest full period in timer ticks
+        _tcb->INTFLAGS = TCB_CAPT_bm;
+        
+        if (!_primed || now - _lastCapture >= _stallMs) {
+            // First edge after start or a stall - the counter may have
+            // wrapped, so this capture only marks the start of a period
+            reset();
+            _primed = true;
+        } else if (period) {
+            if (_count == _samples) {
+                _periodSum -= _periods[_pos];
+            } else {
+                _count++;
+            }
+            _periods[_pos] = period;
+            _periodSum += period;
+            if (++_pos >= _samples) _pos = 0;
+            
+            // RPM = 60 * f_tick * N / (sum of N periods * pulses per rev)
+            uint32_t rpm;
+            if (_rpmScale <= 0xFFFFFFFFUL / _count) {
+                rpm = (_rpmScale * _count) / _periodSum;
+            } else {
+                rpm = _rpmScale / (_periodSum / _count);
+            }
+            _rpm = rpm > 0xFFFF ? 0xFFFF : (uint16_t)rpm;
+            ibus.setRPM(_rpm);
+        }
+        _lastCapture = now;
+    } else if (_primed && now - _lastCapture >= _stallMs) {
+        // No edge for longer than the counter can measure - stopped
+        reset();
+        _primed = false;
+        _rpm = 0;
+        ibus.setRPM(0);
+    }
+}
+
+bool EveryIBusRPM::connectUser(uint8_t channel) {
+    uint8_t user = channel + 1;  // EVSYS_CHANNEL_CHANNELn_gc
+    
+    if (_tcb == &TCB0) {
+        EVSYS.USERTCB0 = user;
+    } else if (_tcb == &TCB1) {
+        EVSYS.USERTCB1 = user;
+#if defined(TCB2)
+    } else if (_tcb == &TCB2) {
+        EVSYS.USERTCB2 = user;
+#endif
+#if defined(TCB3)
+    } else if (_tcb == &TCB3) {
+        EVSYS.USERTCB3 = user;
+#endif
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void EveryIBusRPM::startTimer(uint8_t pulsesPerRev, uint8_t samples) {
+    _pulsesPerRev = pulsesPerRev;
+    _samples = samples;
+    if (_samples < 1) _samples = 1;
+    if (_samples > EVERYIBUS_RPM_MAX_SAMPLES) _samples = EVERYIBUS_RPM_MAX_SAMPLES;
+    
+    // The timer runs from CLK_TCA, so its tick rate follows TCA0's prescaler
+    static const uint16_t divisors[] = { 1, 2, 4, 8, 16, 64, 256, 1024 };
+    uint8_t clksel = (TCA0.SINGLE.CTRLA & TCA_SINGLE_CLKSEL_gm) >> TCA_SINGLE_CLKSEL_gp;
+    uint32_t tickHz = F_CPU / divisors[clksel];
+    
+    _rpmScale = (60UL * tickHz) / pulsesPerRev;
+    
+    // The 16-bit counter wraps after 65536 ticks - give up a little earlier
+    _stallMs = (uint16_t)((65536000UL / tickHz) * 7 / 8);
+    if (_stallMs == 0) _stallMs = 1;
+    
+    _tcb->CTRLA = 0;
+    _tcb->CTRLB = TCB_CNTMODE_FRQ_gc;     // Clear on edge, capture period
+    _tcb->EVCTRL = TCB_CAPTEI_bm;         // Rising edge of the event
+    _tcb->INTCTRL = 0;                    // Polled - no interrupt per pulse
+    _tcb->CNT = 0;
+    _tcb->INTFLAGS = TCB_CAPT_bm;
+    _tcb->CTRLA = TCB_CLKSEL_CLKTCA_gc | TCB_ENABLE_bm;
+    
+    reset();
+    _primed = false;
+    _rpm = 0;
+    _lastCapture = millis();
+    _running = true;
+}
+
+void EveryIBusRPM::reset() {
+    _count = 0;
+    _pos = 0;
+    _periodSum = 0;
+}
+
+#endif // TCB0 && EVSYS
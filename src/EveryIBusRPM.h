@@ -0,0 +1,78 @@
+/*
+  EveryIBusRPM.h - Hardware RPM measurement for EveryIBus
+
+  Measures the pulse period with a TCB in frequency capture mode. The
+  input pin reaches the timer through the event system, so pulses cost
+  no interrupts and no CPU time - update() just harvests the latest
+  captured period, averages the last few and publishes RPM.
+
+  Usage:
+  EveryIBus ibus;
+  EveryIBusRPM rpm;            // Uses TCB2 by default
+
+  void setup() {
+    ibus.begin();
+    rpm.begin(2, 1);           // Pin D2, 1 pulse per revolution
+  }
+
+  void loop() {
+    ibus.update();
+    rpm.update(ibus);          // Feeds the RPM sensor directly
+  }
+
+  Timer clock is CLK_TCA (TCA0 prescaler, 250kHz on the Nano Every core),
+  giving 4us resolution and a lowest measurable speed of about
+  230 RPM at one pulse per revolution.
+*/
+
+#ifndef EVERYIBUS_RPM_H
+#define EVERYIBUS_RPM_H
+
+#include "EveryIBus.h"
+
+#if defined(TCB0) && defined(EVSYS)
+
+// Longest averaging window (in captured periods)
+#ifndef EVERYIBUS_RPM_MAX_SAMPLES
+#define EVERYIBUS_RPM_MAX_SAMPLES 8
+#endif
+
+class EveryIBusRPM {
+public:
+    // TCB0/TCB1 drive PWM and TCB3 runs millis() on the Nano Every core
+    EveryIBusRPM(TCB_t& timer = TCB2);
+
+    // Route a pin through the event system to the timer
+    bool begin(uint8_t pin, uint8_t pulsesPerRev = 1, uint8_t samples = 4);
+
+    // Use an event channel that is already routed (e.g. from AC or CCL)
+    bool beginEvent(uint8_t channel, uint8_t pulsesPerRev = 1, uint8_t samples = 4);
+
+    // Harvest captures and publish to the RPM sensor - call from loop()
+    void update(EveryIBus& ibus);
+
+    uint16_t getRPM() const { return _rpm; }
+
+private:
+    TCB_t* _tcb;
+    uint8_t _pulsesPerRev;
+    uint8_t _samples;
+    uint8_t _count;
+    uint8_t _pos;
+    bool _running;       // Timer configured
+    bool _primed;        // Previous edge seen, next capture is a full period
+    uint16_t _periods[EVERYIBUS_RPM_MAX_SAMPLES];
+    uint32_t _periodSum;
+    uint32_t _rpmScale;      // 60 * tick rate / pulses per revolution
+    uint16_t _stallMs;       // Longest period the 16-bit counter can capture
+    uint32_t _lastCapture;
+    uint16_t _rpm;
+
+    bool connectUser(uint8_t channel);
+    void startTimer(uint8_t pulsesPerRev, uint8_t samples);
+    void reset();
+};
+
+#endif // TCB0 && EVSYS
+
+#endif // EVERYIBUS_RPM_H
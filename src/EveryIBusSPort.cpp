@@ -0,0 +1,259 @@
+/*
+  EveryIBusSPort.cpp - FrSky S.Port telemetry from the EveryIBus sensor table
+
+  Frames are encoded (converted, CRC'd and byte-stuffed) when a slot's
+  value goes live; a poll for our physical ID sends the next ready one.
+*/
+
+#include "EveryIBusSPort.h"
+
+#include <string.h>
+
+EveryIBusSPort::EveryIBusSPort() {
+    _sensors = nullptr;
+    _serial = nullptr;
+    _idByte = 0;
+    _afterStart = false;
+    _next = 0;
+    _pollCount = 0;
+    _responseCount = 0;
+#if EVERYIBUS_STALENESS
+    _failsafeMask = 0;
+#endif
+
+    for (int i = 0; i < MAX_SENSORS; i++) {
+        _frameLen[i] = 0;
+    }
+}
+
+bool EveryIBusSPort::begin(EveryIBus& sensors, uint8_t physicalId, HardwareSerial& port) {
+    if (physicalId > SPORT_MAX_PHYSICAL_ID) return false;
+
+    // One second backend per table
+    if (sensors._slotHook && sensors._slotHookContext != this) return false;
+
+    _sensors = &sensors;
+    _idByte = physicalIdByte(physicalId);
+    sensors._slotHook = slotUpdated;
+    sensors._slotHookContext = this;
+
+    // Values set before begin() are sent right away
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        encodeSlot(i);
+    }
+
+    _serial = &port;
+    _serial->begin(SPORT_BAUD);
+    configureOneWire();
+    return true;
+}
+
+void EveryIBusSPort::configureOneWire() {
+#if defined(ARDUINO_AVR_NANO_EVERY) && defined(USART_LBME_bm)
+    if (_serial != &Serial1) return;
+
+    // Serial1 is USART1 on PC4 (TX, D1) and PC5 (RX, D0). The receiver
+    // pulls the line low between frames; with the pin inverted and
+    // open-drain we only drive it high, and only while sending.
+    USART1.CTRLA |= USART_LBME_bm;      // Receive from the TX pin
+    USART1.CTRLB |= USART_ODME_bm;
+    PORTC.PIN4CTRL |= PORT_INVEN_bm;
+#endif
+}
+
+void EveryIBusSPort::update() {
+    if (!_serial) return;
+
+    // Same bounded work per call as the iBUS side. Our own frames come
+    // back through the one-wire loopback, but stuffing keeps 0x7E out of
+    // them, so they can never look like a poll and need no skipping.
+    uint8_t budget = _sensors->_byteBudget;
+    while (budget && _serial->available()) {
+        uint8_t data = _serial->read();
+        budget--;
+
+        if (data == SPORT_START_BYTE) {
+            _afterStart = true;
+            continue;
+        }
+        if (_afterStart && data == _idByte) {
+            _pollCount++;
+            respond();
+        }
+        _afterStart = false;
+    }
+}
+
+void EveryIBusSPort::respond() {
+    // One value per poll, rotating through the slots that have one
+    for (uint8_t n = 0; n < MAX_SENSORS; n++) {
+        uint8_t slot = _next;
+        _next = (_next + 1 < MAX_SENSORS) ? _next + 1 : 0;
+
+        if (slotReady(slot)) {
+            _serial->write(_frames[slot], _frameLen[slot]);
+            _responseCount++;
+            return;
+        }
+    }
+}
+
+bool EveryIBusSPort::slotReady(uint8_t slot) {
+    if (!_frameLen[slot]) return false;
+
+#if EVERYIBUS_STALENESS
+    const Sensor& sensor = _sensors->_sensors[slot];
+    if (sensor.maxAge && (millis() - sensor.updatedAt) > sensor.maxAge) {
+        if (sensor.staleMode == IBUS_STALE_SILENT) return false;
+
+        // Switch once, like the iBUS side; the next set re-encodes
+        if (!(_failsafeMask & (1u << slot))) {
+            _failsafeMask |= (1u << slot);
+            encodeSlot(slot, true);
+        }
+    }
+#endif
+    return _frameLen[slot] != 0;
+}
+
+void EveryIBusSPort::slotUpdated(void* context, uint8_t slot) {
+    EveryIBusSPort* self = static_cast<EveryIBusSPort*>(context);
+
+    // Setter side: encode next to the live frame and copy it in, so a
+    // poll answered from an interrupt never sees half a frame
+    uint8_t frame[SPORT_MAX_FRAME_LEN];
+    uint8_t length = self->buildFrame(slot, false, frame);
+
+    noInterrupts();
+    memcpy(self->_frames[slot], frame, length);
+    self->_frameLen[slot] = length;
+    interrupts();
+}
+
+void EveryIBusSPort::encodeSlot(uint8_t slot, bool failsafe) {
+    _frameLen[slot] = buildFrame(slot, failsafe, _frames[slot]);
+}
+
+uint8_t EveryIBusSPort::buildFrame(uint8_t slot, bool failsafe, uint8_t* out) {
+    const Sensor& sensor = _sensors->_sensors[slot];
+    uint16_t dataId = (sensor.type != 0xFF && sensor.hasValue) ? dataIdFor(sensor.type) : 0;
+    if (!dataId) return 0;
+
+    // Further slots of a type become instances 1, 2, ... of its ID
+    for (uint8_t i = 0; i < slot; i++) {
+        if (_sensors->_sensors[i].type == sensor.type) dataId++;
+    }
+
+    uint16_t raw = sensor.value;
+    int32_t wide = raw;
+#if EVERYIBUS_WIDE_SENSORS
+    wide = (int32_t)(((uint32_t)sensor.valueHigh << 16) | raw);
+#endif
+#if EVERYIBUS_STALENESS
+    if (failsafe) {
+        raw = sensor.failsafeValue;
+        wide = raw;
+    } else {
+        _failsafeMask &= ~(1u << slot);
+    }
+#else
+    (void)failsafe;
+#endif
+
+    // iBUS raw units to S.Port units
+    uint32_t value;
+    switch (sensor.type) {
+        case IBUS_SENSOR_TEMPERATURE:
+            value = (uint32_t)(((int32_t)raw - 400) / 10);     // 0.1°C + 40°C -> °C
+            break;
+        case IBUS_SENSOR_CURRENT:
+            value = raw / 10;                                  // 0.01A -> 0.1A
+            break;
+        case IBUS_SENSOR_HEADING:
+            value = (uint32_t)raw * 100;                       // ° -> 0.01°
+            break;
+        case IBUS_SENSOR_CLIMB_RATE:
+            value = (uint32_t)(int32_t)(int16_t)raw;           // Signed 0.01m/s
+            break;
+        case IBUS_SENSOR_GPS_LAT:
+        case IBUS_SENSOR_GPS_LON: {
+            // 1e-7° -> 1e-4 minutes; bit 31 = longitude, bit 30 = S/W
+            uint32_t magnitude = wide < 0 ? 0u - (uint32_t)wide : (uint32_t)wide;
+            value = (magnitude / 100 * 6) & 0x3FFFFFFF;
+            if (sensor.type == IBUS_SENSOR_GPS_LON) value |= 0x80000000;
+            if (wide < 0) value |= 0x40000000;
+            break;
+        }
+        case IBUS_SENSOR_ALTITUDE:
+        case IBUS_SENSOR_GPS_ALT:
+            value = (uint32_t)wide;                            // Signed 0.01m
+            break;
+        default:
+            value = raw;
+            break;
+    }
+
+    return encodeFrame(dataId, value, out);
+}
+
+uint8_t EveryIBusSPort::physicalIdByte(uint8_t physicalId) {
+    // Bits 5-7 are parity over the 5-bit ID, so a corrupted poll byte
+    // rarely matches another sensor's ID
+    uint8_t id = physicalId & 0x1F;
+    uint8_t b0 = id & 1, b1 = (id >> 1) & 1, b2 = (id >> 2) & 1;
+    uint8_t b3 = (id >> 3) & 1, b4 = (id >> 4) & 1;
+    return id | ((b0 ^ b1 ^ b2) << 5) | ((b2 ^ b3 ^ b4) << 6) | ((b0 ^ b2 ^ b4) << 7);
+}
+
+uint16_t EveryIBusSPort::dataIdFor(uint8_t sensorType) {
+    switch (sensorType) {
+        case IBUS_SENSOR_INTERNAL_VOLTAGE: return SPORT_ID_A3;
+        case IBUS_SENSOR_EXTERNAL_VOLTAGE: return SPORT_ID_VFAS;
+        case IBUS_SENSOR_CELL_VOLTAGE:     return SPORT_ID_A4;
+        case IBUS_SENSOR_CURRENT:          return SPORT_ID_CURR;
+        case IBUS_SENSOR_TEMPERATURE:      return SPORT_ID_T1;
+        case IBUS_SENSOR_RPM:              return SPORT_ID_RPM;
+        case IBUS_SENSOR_FUEL:             return SPORT_ID_FUEL;
+        case IBUS_SENSOR_HEADING:          return SPORT_ID_GPS_COURSE;
+        case IBUS_SENSOR_CLIMB_RATE:       return SPORT_ID_VARIO;
+#if EVERYIBUS_WIDE_SENSORS
+        case IBUS_SENSOR_ALTITUDE:         return SPORT_ID_ALT;
+        case IBUS_SENSOR_GPS_ALT:          return SPORT_ID_GPS_ALT;
+        case IBUS_SENSOR_GPS_LAT:
+        case IBUS_SENSOR_GPS_LON:          return SPORT_ID_GPS_LONG_LATI;
+#endif
+        default:                           return 0;
+    }
+}
+
+static uint8_t putStuffed(uint8_t* out, uint8_t length, uint8_t data) {
+    // 0x7E starts a poll and 0x7D escapes - neither may appear in a frame
+    if (data == SPORT_START_BYTE || data == SPORT_STUFF_BYTE) {
+        out[length++] = SPORT_STUFF_BYTE;
+        data ^= SPORT_STUFF_MASK;
+    }
+    out[length++] = data;
+    return length;
+}
+
+uint8_t EveryIBusSPort::encodeFrame(uint16_t dataId, uint32_t value, uint8_t* out) {
+    uint8_t frame[7];
+    frame[0] = SPORT_DATA_FRAME;
+    frame[1] = dataId & 0xFF;
+    frame[2] = dataId >> 8;
+    frame[3] = value & 0xFF;
+    frame[4] = (value >> 8) & 0xFF;
+    frame[5] = (value >> 16) & 0xFF;
+    frame[6] = value >> 24;
+
+    // CRC over the unstuffed bytes: sum with end-around carry, inverted
+    uint16_t crc = 0;
+    uint8_t length = 0;
+    for (uint8_t i = 0; i < sizeof(frame); i++) {
+        crc += frame[i];
+        crc += crc >> 8;
+        crc &= 0xFF;
+        length = putStuffed(out, length, frame[i]);
+    }
+    return putStuffed(out, length, 0xFF - crc);
+}
@@ -0,0 +1,116 @@
+/*
+  EveryIBusSPort.h - FrSky S.Port telemetry from the EveryIBus sensor table
+
+  The same sketch and the same setters drive a FrSky receiver: every
+  sensor slot of an EveryIBus instance is mapped to an S.Port data ID,
+  and its stuffed response frame is encoded when the value goes live.
+  Answering a poll only hands the next ready frame to the serial port.
+
+  Usage:
+  EveryIBus ibus;              // Sensor table (no begin() needed)
+  EveryIBusSPort sport;
+
+  void setup() {
+    sport.begin(ibus, 0x0D);   // Physical ID 0x00-0x1B
+  }
+
+  void loop() {
+    sport.update();
+    ibus.setExternalVoltage(12.41);   // Sent as VFAS
+  }
+
+  S.Port is inverted, half-duplex 57600 8N1 on one wire. On the Nano
+  Every, Serial1 is switched to one-wire mode with its TX pin (D1)
+  inverted and open-drain, so D1 connects straight to the S.Port signal.
+  Other ports need an external inverter and a diode or resistor to join
+  RX and TX.
+
+  Type mapping (multiple slots of a type get instances 0, 1, ...):
+    Internal voltage  A3    0x0900  0.01V
+    External voltage  VFAS  0x0210  0.01V
+    Cell voltage      A4    0x0910  0.01V
+    Current           CURR  0x0200  0.1A
+    Temperature       T1    0x0400  1°C
+    RPM               RPM   0x0500
+    Fuel (mAh)        FUEL  0x0600
+    Heading           GPS course 0x0840  0.01°
+    Climb rate        VSpd  0x0110  0.01m/s
+    Altitude          Alt   0x0100  0.01m
+    GPS altitude      GAlt  0x0820  0.01m
+    GPS lat/lon       GPS   0x0800  FrSky minute encoding
+  Other types are not sent.
+*/
+
+#ifndef EVERYIBUS_SPORT_H
+#define EVERYIBUS_SPORT_H
+
+#include "EveryIBus.h"
+
+#define SPORT_BAUD                57600
+#define SPORT_START_BYTE          0x7E
+#define SPORT_STUFF_BYTE          0x7D
+#define SPORT_STUFF_MASK          0x20
+#define SPORT_DATA_FRAME          0x10
+#define SPORT_MAX_PHYSICAL_ID     0x1B
+
+// Frame type + 2 ID bytes + 4 value bytes + CRC, each possibly stuffed
+#define SPORT_MAX_FRAME_LEN       16
+
+// Data IDs (first instance)
+#define SPORT_ID_ALT              0x0100
+#define SPORT_ID_VARIO            0x0110
+#define SPORT_ID_CURR             0x0200
+#define SPORT_ID_VFAS             0x0210
+#define SPORT_ID_T1               0x0400
+#define SPORT_ID_RPM              0x0500
+#define SPORT_ID_FUEL             0x0600
+#define SPORT_ID_GPS_LONG_LATI    0x0800
+#define SPORT_ID_GPS_ALT          0x0820
+#define SPORT_ID_GPS_COURSE       0x0840
+#define SPORT_ID_A3               0x0900
+#define SPORT_ID_A4               0x0910
+
+class EveryIBusSPort {
+public:
+    EveryIBusSPort();
+
+    // Answer polls for physicalId with the slots of sensors. The table
+    // can also run its own iBUS port at the same time.
+    bool begin(EveryIBus& sensors, uint8_t physicalId, HardwareSerial& port = Serial1);
+
+    // Call from loop() - reads at most the EveryIBus byte budget per call
+    void update();
+
+    uint32_t getPollCount() const { return _pollCount; }
+    uint32_t getResponseCount() const { return _responseCount; }
+
+    // Protocol helpers (pure functions)
+    static uint8_t physicalIdByte(uint8_t physicalId);  // With check bits
+    static uint16_t dataIdFor(uint8_t sensorType);       // 0 = not sent
+    static uint8_t encodeFrame(uint16_t dataId, uint32_t value, uint8_t* out);
+
+private:
+    EveryIBus* _sensors;
+    HardwareSerial* _serial;
+    uint8_t _idByte;
+    bool _afterStart;            // Last byte was 0x7E, next one is an ID
+    uint8_t _next;               // Round-robin position over the slots
+    uint32_t _pollCount;
+    uint32_t _responseCount;
+
+    // Encoded response per slot, length 0 = nothing to send
+    uint8_t _frames[MAX_SENSORS][SPORT_MAX_FRAME_LEN];
+    uint8_t _frameLen[MAX_SENSORS];
+#if EVERYIBUS_STALENESS
+    uint16_t _failsafeMask;      // Slots currently holding their failsafe frame
+#endif
+
+    static void slotUpdated(void* context, uint8_t slot);
+    void encodeSlot(uint8_t slot, bool failsafe = false);
+    uint8_t buildFrame(uint8_t slot, bool failsafe, uint8_t* out);
+    bool slotReady(uint8_t slot);
+    void respond();
+    void configureOneWire();
+};
+
+#endif // EVERYIBUS_SPORT_H
@@ -0,0 +1,62 @@
+/*
+  EveryIBusTransport.h - Byte transport for the EveryIBus protocol core
+
+  EveryIBus turns received bytes into finished response frames; the
+  transport only moves bytes in and frames out. Which transport is used
+  is decided at compile time (EVERYIBUS_TRANSPORT in EveryIBusConfig.h)
+  and EveryIBus holds it by value, so every call is a direct, normally
+  inlined call - no virtual functions, no extra RAM for a vtable.
+
+  A transport provides:
+    typedef ... Port;                   // What begin() is handed
+    static Port& defaultPort();         // begin() without arguments
+    void begin(Port& port);             // Open at 115200 8N1
+    bool isOpen() const;
+    int available();
+    uint8_t read();                     // Only when available() > 0
+    void write(const uint8_t* data, uint8_t length);
+
+  Another transport (a register-level USART driver, the in-memory one
+  in extras/linux/MockTransport.h for host tests) is selected with
+  build flags, e.g.
+    -DEVERYIBUS_TRANSPORT=MockTransport
+    -DEVERYIBUS_TRANSPORT_HEADER='"MockTransport.h"'
+*/
+
+#ifndef EVERYIBUS_TRANSPORT_H
+#define EVERYIBUS_TRANSPORT_H
+
+#include <Arduino.h>
+
+// Default: the core's HardwareSerial (interrupt-driven, buffered)
+class EveryIBusSerialTransport {
+public:
+    typedef HardwareSerial Port;
+    static Port& defaultPort() { return Serial1; }
+
+    EveryIBusSerialTransport() : _serial(nullptr) {}
+
+    void begin(Port& port) {
+        _serial = &port;
+        _serial->begin(115200);
+    }
+
+    bool isOpen() const { return _serial != nullptr; }
+    int available() { return _serial->available(); }
+    uint8_t read() { return _serial->read(); }
+
+    void write(const uint8_t* data, uint8_t length) {
+        for (uint8_t i = 0; i < length; i++) {
+            _serial->write(data[i]);
+        }
+    }
+
+private:
+    HardwareSerial* _serial;
+};
+
+#ifdef EVERYIBUS_TRANSPORT_HEADER
+#include EVERYIBUS_TRANSPORT_HEADER
+#endif
+
+#endif // EVERYIBUS_TRANSPORT_H